@@ -0,0 +1,114 @@
+// Файл: AdaptiveLimiter.h
+#ifndef ADAPTIVELIMITER_H
+#define ADAPTIVELIMITER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
+
+class QNetworkReply;
+
+/**
+ * @class AdaptiveLimiter
+ * @brief Адаптивное ограничение числа одновременных запросов (AIMD)
+ *
+ * Пока p95 задержки держится около базового уровня, лимит растет на единицу
+ * за "окно" запросов; при росте p95, ответах 5xx/429 или сетевых ошибках лимит
+ * умножается на 0.7. Заголовок Retry-After приостанавливает отправку.
+ * Запросы сверх лимита ждут в очереди; интерактивные идут раньше фоновых.
+ */
+class AdaptiveLimiter : public QObject {
+    Q_OBJECT
+public:
+    /// Функция, отправляющая запрос; может вернуть nullptr, если отправлять нечего
+    using StartFunction = std::function<QNetworkReply*()>;
+
+    explicit AdaptiveLimiter(QObject* parent = nullptr);
+
+    /**
+     * @brief Ставит запрос в очередь
+     * @param start Отправляет запрос, когда освободится место
+     * @param lowPriority Фоновый запрос: уступает интерактивным и
+     *        не занимает последнее свободное место
+     * @param onDropped Вызывается, если фоновый запрос удален из очереди
+     */
+    void submit(StartFunction start, bool lowPriority = false,
+                std::function<void()> onDropped = std::function<void()>());
+
+    /**
+     * @brief Удаляет из очереди все фоновые запросы
+     */
+    void dropLowPriority();
+
+    /**
+     * @brief Задает границы лимита
+     */
+    void setLimits(int minLimit, int maxLimit);
+
+    /**
+     * @brief Во сколько раз p95 может превысить базовый уровень до снижения лимита
+     */
+    void setLatencyTolerance(double factor);
+
+    /**
+     * @brief Текущий лимит одновременных запросов
+     */
+    int currentLimit() const;
+
+    /**
+     * @brief Число выполняющихся запросов
+     */
+    int inFlight() const;
+
+    /**
+     * @brief Число запросов в очереди
+     */
+    int queued() const;
+
+    /**
+     * @brief p95 задержки по последним запросам, мс
+     */
+    double latencyP95() const;
+
+signals:
+    /**
+     * @brief Сигнал изменения лимита
+     * @param limit Новый лимит одновременных запросов
+     */
+    void limitChanged(int limit);
+
+private:
+    /// Запрос, ожидающий места
+    struct Pending {
+        StartFunction start;
+        std::function<void()> onDropped;
+    };
+
+    QQueue<Pending> interactive;   ///< Очередь интерактивных запросов
+    QQueue<Pending> background;    ///< Очередь фоновых запросов
+    double limit = 4.0;            ///< Текущий лимит (дробный для плавного роста)
+    int minLimit = 1;
+    int maxLimit = 32;
+    double tolerance = 2.0;
+    int active = 0;                ///< Выполняющиеся запросы
+    QVector<double> samples;       ///< Кольцевой буфер последних задержек, мс
+    int nextSample = 0;
+    double baselineMs = -1.0;      ///< Базовый уровень p95
+    QElapsedTimer clock;
+    qint64 pausedUntilMs = 0;      ///< Отправка приостановлена по Retry-After
+    qint64 lastDecreaseMs = -1;
+    QTimer resumeTimer;
+
+    void pump();
+    void onFinished(QNetworkReply* reply, qint64 startedMs);
+    void recordLatency(double ms);
+    void increase();
+    void decrease();
+    void setLimit(double value);
+    static qint64 retryAfterMs(QNetworkReply* reply);
+};
+
+#endif // ADAPTIVELIMITER_H
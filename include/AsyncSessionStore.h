@@ -0,0 +1,65 @@
+// Файл: AsyncSessionStore.h
+#ifndef ASYNCSESSIONSTORE_H
+#define ASYNCSESSIONSTORE_H
+
+#include "SessionStore.h"
+#include <QString>
+#include <QTimer>
+#include <QThreadPool>
+
+/**
+ * @class AsyncSessionStore
+ * @brief Хранилище сессии с фоновой отложенной записью
+ *
+ * Загрузка и запись выполняются в отдельном потоке, поэтому обновление
+ * токенов не ждет диска. Частые сохранения
+ * объединяются в одну запись; файл заменяется атомарно (QSaveFile),
+ * так что сбой посреди записи оставляет предыдущую версию целой.
+ * При первом запуске переносит токены из старой группы QSettings.
+ * Неудачная запись сообщается сигналом error().
+ */
+class AsyncSessionStore : public SessionStore {
+    Q_OBJECT
+public:
+    /**
+     * @param path Путь к файлу сессии
+     * @param legacyGroup Группа QSettings, из которой переносятся старые токены
+     *        (пустая строка - без переноса)
+     * @param parent Родительский объект Qt
+     */
+    explicit AsyncSessionStore(const QString& path, const QString& legacyGroup = QString(),
+                               QObject* parent = nullptr);
+
+    /**
+     * @brief Дожидается записи всех изменений
+     */
+    ~AsyncSessionStore() override;
+
+    void load() override;
+    void save(const SessionState& state) override;
+    void clear() override;
+
+    /**
+     * @brief Задает задержку, в течение которой сохранения объединяются
+     */
+    void setCoalesceInterval(int ms);
+
+    /**
+     * @brief Немедленно отправляет отложенное изменение на запись
+     */
+    void flush();
+
+private:
+    QString m_path;
+    QString m_legacyGroup;
+    QThreadPool worker;     ///< Один поток: операции с файлом идут строго по очереди
+    QTimer flushTimer;      ///< Отложенная запись
+    SessionState pending;   ///< Последнее несохраненное состояние
+    bool hasPending = false;
+
+    void reportError(const QString& message);
+    static SessionState readFile(const QString& path, bool* exists);
+    static bool writeFile(const QString& path, const SessionState& state);
+};
+
+#endif // ASYNCSESSIONSTORE_H
@@ -13,6 +13,27 @@
 #include <QJsonDocument>
 #include <QNetworkRequest>
 #include <QSslConfiguration>
+#include <QPointer>
+#include "SessionState.h"
+#include "SseParser.h"
+#include <functional>
+
+class TopicGraph;
+class SearchIndex;
+class PrefetchEngine;
+class SessionStore;
+class AdaptiveLimiter;
+class EndpointSelector;
+class AuthHandler;
+class CoursesHandler;
+class TopicHandler;
+class RegistrationHandler;
+
+namespace Api {
+struct Courses;
+struct CourseTopics;
+struct Subtopics;
+}
 
 /**
  * @class CNetworkWrapper
@@ -32,6 +53,48 @@ public:
      */
     explicit CNetworkWrapper(QObject *parent = nullptr);
 
+    /**
+     * @brief Конструктор сессии поверх общего транспорта
+     *
+     * Позволяет держать в одном процессе много независимых сессий,
+     * например для нагрузочного тестирования.
+     * @param transport Общий менеджер сетевых запросов; nullptr - создать свой
+     * @param store Хранилище токенов (переходит во владение обертки);
+     *        nullptr - сессия хранится только в памяти
+     * @param parent Родительский объект Qt
+     */
+    CNetworkWrapper(QNetworkAccessManager* transport, SessionStore* store,
+                    QObject *parent = nullptr);
+
+    /**
+     * @brief Задает базовый URL API
+     * @param url Адрес сервера, например "http://127.0.0.1:8080"
+     */
+    void setBaseUrl(const QString& url);
+
+    /**
+     * @brief Задает несколько серверов API
+     *
+     * Запросы направляются на доступный сервер с наименьшей задержкой,
+     * при ошибке соединения автоматически повторяются на другом сервере.
+     * @param urls Базовые URL серверов
+     */
+    void setEndpoints(const QStringList& urls);
+
+    /**
+     * @brief Возвращает объект выбора сервера (задержки, доступность)
+     */
+    EndpointSelector* endpointSelector() const;
+
+    /**
+     * @brief Подключает общий объект выбора сервера
+     *
+     * Обертки на одном транспорте могут делить статистику и фоновые
+     * проверки серверов. Объект должен жить дольше обертки.
+     * @param shared Общий объект выбора сервера
+     */
+    void setEndpointSelector(EndpointSelector* shared);
+
     /**
      * @brief Выполняет аутентификацию пользователя
      * @param email Электронная почта пользователя
@@ -51,6 +114,26 @@ public:
      */
     void fetchCourses();
 
+    /**
+     * @brief Запрашивает одну страницу списка курсов
+     * @param offset Смещение первого курса
+     * @param limit Размер страницы
+     * @return Номер запроса, который придет в coursesPageReceived или
+     *         coursesPageFailed; 0, если запрос не отправлен
+     */
+    quint64 fetchCoursesPage(int offset, int limit);
+
+    /**
+     * @brief Запрашивает одну страницу подтем
+     * @param courseId Идентификатор курса
+     * @param parentTopicId Родительская тема (-1 для корневых тем курса)
+     * @param offset Смещение первой темы
+     * @param limit Размер страницы
+     * @return Номер запроса, который придет в subtopicsPageReceived или
+     *         subtopicsPageFailed; 0, если запрос не отправлен
+     */
+    quint64 fetchTopicsPage(int courseId, int parentTopicId, int offset, int limit);
+
     /**
      * @brief Восстанавливает сессию из сохраненных токенов
      */
@@ -73,6 +156,83 @@ public:
          */
         QString getUserRole() const;
 
+    /**
+     * @brief Возвращает учетную запись текущей сессии
+     * @return Email, указанный при входе, или пустая строка
+     */
+    QString currentUser() const;
+
+    /**
+     * @brief Возвращает общее дерево тем, собираемое из ответов сервера
+     */
+    TopicGraph* topicGraph() const;
+
+    /**
+     * @brief Возвращает локальный поисковый индекс по курсам, темам и материалам
+     */
+    SearchIndex* searchIndex() const;
+
+    /**
+     * @brief Возвращает адаптивный ограничитель параллельных запросов
+     *
+     * Текущий лимит доступен через currentLimit() и сигнал limitChanged.
+     */
+    AdaptiveLimiter* concurrencyLimiter() const;
+
+    /**
+     * @brief Подключает упреждающую загрузку тем
+     * @param engine Движок упреждающей загрузки или nullptr, чтобы отключить ее
+     */
+    void setPrefetchEngine(PrefetchEngine* engine);
+
+    /**
+     * @brief Загружает корневые темы курса с низким приоритетом
+     *
+     * Результат передается движку упреждающей загрузки, сигнал
+     * subtopicsFetched не испускается.
+     * @param courseId Идентификатор курса
+     */
+    void prefetchTopics(int courseId);
+
+    /**
+     * @brief Отменяет все активные упреждающие запросы
+     */
+    void cancelPrefetches();
+
+    /**
+     * @brief Обновляет токен доступа
+     */
+    void refreshAuthToken();
+
+    /**
+     * @brief Подписывается на уведомления об изменениях курсов и тем
+     *
+     * Держит долгоживущий поток Server-Sent Events, применяет изменения
+     * к дереву тем и поисковому индексу и испускает сигналы об изменениях.
+     * При разрыве переподключается и продолжает с последнего события.
+     * Поток без данных дольше setChangeStreamIdleTimeout() считается
+     * оборванным. Ответы 204, 403 и 404 завершают подписку.
+     */
+    void subscribeChanges();
+
+    /**
+     * @brief Задает, сколько поток может молчать до переподключения
+     *
+     * Должно быть больше периода пустых комментариев-пульсов сервера.
+     * @param ms Время в миллисекундах
+     */
+    void setChangeStreamIdleTimeout(int ms);
+
+    /**
+     * @brief Закрывает поток уведомлений об изменениях
+     */
+    void unsubscribeChanges();
+
+    /**
+     * @brief Проверяет, включена ли подписка на изменения
+     */
+    bool isSubscribedToChanges() const;
+
 signals:
     /**
      * @brief Сигнал успешной аутентификации
@@ -117,47 +277,243 @@ signals:
     void subtopicsFetched(int parentTopicId, const QJsonArray& subtopics);
     void materialsFetched(int topicId, const QJsonArray& materials);
 
+    /**
+     * @brief Сигнал получения страницы курсов
+     * @param offset Смещение первого курса страницы
+     * @param courses Курсы страницы
+     * @param totalCount Общее число курсов или -1, если неизвестно
+     * @param requestId Номер запроса из fetchCoursesPage()
+     */
+    void coursesPageReceived(int offset, const QJsonArray& courses, int totalCount,
+                             quint64 requestId);
+
+    /**
+     * @brief Сигнал получения страницы подтем
+     * @param courseId Идентификатор курса
+     * @param parentTopicId Родительская тема (-1 для корневых тем)
+     * @param offset Смещение первой темы страницы
+     * @param subtopics Темы страницы
+     * @param totalCount Общее число тем или -1, если неизвестно
+     * @param requestId Номер запроса из fetchTopicsPage()
+     */
+    void subtopicsPageReceived(int courseId, int parentTopicId, int offset,
+                               const QJsonArray& subtopics, int totalCount, quint64 requestId);
+
+    /**
+     * @brief Сигнал неудачной загрузки страницы курсов
+     *
+     * Ошибка сети или HTTP, пустой или неразборчивый ответ.
+     * @param offset Смещение первого курса страницы
+     * @param requestId Номер запроса из fetchCoursesPage()
+     */
+    void coursesPageFailed(int offset, quint64 requestId);
+
+    /**
+     * @brief Сигнал неудачной загрузки страницы подтем
+     * @param courseId Идентификатор курса
+     * @param parentTopicId Родительская тема (-1 для корневых тем)
+     * @param offset Смещение первой темы страницы
+     * @param requestId Номер запроса из fetchTopicsPage()
+     */
+    void subtopicsPageFailed(int courseId, int parentTopicId, int offset, quint64 requestId);
+
+    /**
+     * @brief Сигнал изменения или создания курса
+     * @param course Актуальные данные курса
+     * @param created true - курс новый, false - изменен существующий
+     */
+    void courseChanged(const QJsonObject& course, bool created);
+
+    /**
+     * @brief Сигнал удаления курса
+     */
+    void courseRemoved(int courseId);
+
+    /**
+     * @brief Сигнал изменения или создания темы
+     * @param courseId Идентификатор курса
+     * @param parentTopicId Родительская тема (-1 для корневых тем)
+     * @param topic Актуальные данные темы
+     * @param created true - тема новая, false - изменена существующая
+     */
+    void topicChanged(int courseId, int parentTopicId, const QJsonObject& topic, bool created);
+
+    /**
+     * @brief Сигнал удаления темы
+     */
+    void topicRemoved(int courseId, int topicId);
+
+    /**
+     * @brief Сигнал изменения состояния потока уведомлений
+     * @param connected true, если поток открыт
+     */
+    void changeStreamStateChanged(bool connected);
+
     public slots:
     void fetchTopics(int courseId, int parentTopicId = -1);
 
-    
-private slots:
-    void handleNetworkReply(QNetworkReply* reply, const QByteArray& data);
-
 private:
     QNetworkAccessManager* manager;      ///< Менеджер сетевых запросов
-    QString baseUrl = "http://185.125.100.45:8080"; ///< Базовый URL API
-    QString accessToken;                 ///< Текущий токен доступа
-    QString refreshToken;                ///< Токен для обновления сессии
+    TopicGraph* graph;                   ///< Дерево загруженных тем
+    SearchIndex* index;                  ///< Поисковый индекс каталога
+    AdaptiveLimiter* limiter;            ///< Ограничитель параллельных запросов
+    EndpointSelector* selector;          ///< Выбор сервера API
+    QString authEndpoint;                ///< Сервер, выдавший токены этой сессии
+    QPointer<PrefetchEngine> prefetcher; ///< Движок упреждающей загрузки
+    QList<QPointer<QNetworkReply>> prefetchReplies; ///< Активные упреждающие запросы
+    SessionState session;                ///< Токены и роль текущей сессии
+    QByteArray bearerHeader;             ///< Готовый заголовок Authorization
+    SessionStore* store;                 ///< Хранилище токенов (nullptr - не сохранять)
     QTimer tokenRefreshTimer;            ///< Таймер для обновления токенов
-    QString userRole; ///< Роль текущего пользователя
+    QPointer<QNetworkReply> changeStream; ///< Поток уведомлений об изменениях
+    SseParser sseParser;                 ///< Разбор потока уведомлений
+    QString lastEventId;                 ///< Последнее полученное событие
+    QTimer streamReconnectTimer;         ///< Отложенное переподключение потока
+    QTimer streamIdleTimer;              ///< Сторож молчащего потока
+    int streamAttempts = 0;              ///< Неудачных переподключений подряд
+    bool changesWanted = false;          ///< Подписка включена пользователем
+    quint64 lastPageRequest = 0;         ///< Номер последнего запроса страницы
 
     /**
      * @brief Инициализирует таймер обновления токенов
      */
     void initRefreshTimer();
 
-    /**
-     * @brief Обновляет токен доступа
-     */
-    void refreshAuthToken();
-
     /**
      * @brief Сохраняет токены в безопасное хранилище
      */
     void saveTokens();
 
     /**
-     * @brief Загружает сохраненные токены
+     * @brief Запускает загрузку сохраненных токенов
      */
     void loadTokens();
 
+    /**
+     * @brief Применяет загруженную сессию и проверяет ее активность
+     * @param state Сессия из хранилища
+     */
+    void applyLoadedSession(const SessionState& state);
+
+    /**
+     * @brief Пересобирает заголовок Authorization после смены токена
+     */
+    void updateBearerHeader();
+
+    /**
+     * @brief Проверяет ответ и разбирает JSON
+     * @param reply Завершенный ответ
+     * @param data Тело ответа
+     * @param doc Разобранный документ
+     * @return true, если документ можно передавать разборщику конечной точки
+     */
+    bool handleNetworkReply(QNetworkReply* reply, const QByteArray& data, QJsonDocument& doc);
+
+    /**
+     * @brief Разбирает ответ обработчиком из описания конечной точки
+     *
+     * Тип обработчика и подключение его сигналов выбираются при компиляции.
+     * @tparam E Конечная точка из Api
+     */
+    template <typename E>
+    void decodeReply(QNetworkReply* reply, const QJsonDocument& doc);
+
+    /**
+     * @brief Разбирает страницу списка конечной точки
+     * @tparam E Конечная точка из Api
+     * @param requestId Номер запроса страницы
+     * @param ids Идентификаторы из пути запроса
+     * @return true, если страница доставлена подписчикам
+     */
+    template <typename E, typename... Ids>
+    bool decodePage(const QJsonDocument& doc, quint64 requestId, int offset, int limit, Ids... ids);
+
+    /**
+     * @brief Сообщает об ошибке, если ответ ее содержит
+     * @return true, если ответ - ошибка
+     */
+    bool handleErrorResponse(const QJsonObject& response);
+
+    /**
+     * @brief Подключает сигналы обработчика к обертке
+     *
+     * Новому типу обработчика нужна своя перегрузка.
+     * @param handler Обработчик ответа
+     * @param reply Ответ, контекст запроса берется из его свойств
+     */
+    void bindHandler(AuthHandler& handler, QNetworkReply* reply);
+    void bindHandler(CoursesHandler& handler, QNetworkReply* reply);
+    void bindHandler(TopicHandler& handler, QNetworkReply* reply);
+    void bindHandler(RegistrationHandler& handler, QNetworkReply* reply);
+
     /**
      * @brief Отправляет POST-запрос
-     * @param endpoint Конечная точка API
+     * @tparam E Конечная точка из Api
      * @param data Данные для отправки
+     * @param context Контекст, сохраняемый в свойствах ответа
      */
-    void sendPostRequest(const QString& endpoint, const QJsonObject& data);
+    template <typename E>
+    void sendPostRequest(const QJsonObject& data, const QVariantMap& context = QVariantMap());
+
+    /**
+     * @brief Отправляет GET-запрос страницы списка
+     * @tparam E Конечная точка из Api
+     * @param offset Смещение первого элемента
+     * @param limit Размер страницы
+     * @param ids Идентификаторы для шаблона пути
+     * @return Номер запроса
+     */
+    template <typename E, typename... Ids>
+    quint64 sendPageRequest(int offset, int limit, Ids... ids);
+
+    /**
+     * @brief Доставляет страницу списка подписчикам
+     *
+     * Перегрузка выбирается по конечной точке при компиляции.
+     */
+    void deliverPage(Api::Courses, quint64 requestId, int offset, const QJsonArray& items,
+                     int totalCount);
+    void deliverPage(Api::CourseTopics, quint64 requestId, int offset, const QJsonArray& items,
+                     int totalCount, int courseId);
+    void deliverPage(Api::Subtopics, quint64 requestId, int offset, const QJsonArray& items,
+                     int totalCount, int courseId, int parentTopicId);
+
+    /**
+     * @brief Сообщает подписчикам, что страница не получена
+     */
+    void reportPageFailed(Api::Courses, quint64 requestId, int offset);
+    void reportPageFailed(Api::CourseTopics, quint64 requestId, int offset, int courseId);
+    void reportPageFailed(Api::Subtopics, quint64 requestId, int offset, int courseId, int parentTopicId);
+
+    /// Как выбирать сервер для запроса
+    enum class Route {
+        Fastest,  ///< Доступный сервер с наименьшей задержкой
+        Sticky    ///< Сервер, выдавший токены (вход и обновление токенов)
+    };
+
+    /**
+     * @brief Отправляет запрос через адаптивный ограничитель
+     *
+     * При ошибке соединения помечает сервер недоступным и повторяет
+     * запрос на другом сервере.
+     * @param send Создает запрос к переданному базовому URL, когда для него освободится место
+     * @param onFinished Обработчик завершенного ответа
+     * @param lowPriority Фоновый запрос, уступающий интерактивным
+     * @param onDropped Вызывается, если фоновый запрос отменен в очереди
+     * @param route Правило выбора сервера
+     * @param idempotent Запрос можно повторить, даже если он мог дойти до сервера
+     * @param attempt Номер попытки
+     */
+    void dispatchRequest(std::function<QNetworkReply*(const QString&)> send,
+                         std::function<void(QNetworkReply*)> onFinished,
+                         bool lowPriority = false,
+                         std::function<void()> onDropped = std::function<void()>(),
+                         Route route = Route::Fastest, bool idempotent = true, int attempt = 0);
+
+    /**
+     * @brief Проверяет, что запрос не дошел до сервера или ответ не получен
+     */
+    static bool isConnectionError(QNetworkReply::NetworkError error);
 
     /**
      * @brief Обрабатывает ответ аутентификации
@@ -173,6 +529,21 @@ private:
     
     
     void handleNetworkError(QNetworkReply* reply, int status, const QByteArray &responseData);
+
+    /**
+     * @brief Открывает поток уведомлений с последнего полученного события
+     */
+    void openChangeStream();
+
+    /**
+     * @brief Планирует переподключение потока с нарастающей задержкой
+     */
+    void scheduleStreamReconnect();
+
+    /**
+     * @brief Применяет одно уведомление об изменении
+     */
+    void handleChangeEvent(const SseEvent& event);
     
 };
 
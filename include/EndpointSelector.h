@@ -0,0 +1,103 @@
+// Файл: EndpointSelector.h
+#ifndef ENDPOINTSELECTOR_H
+#define ENDPOINTSELECTOR_H
+
+#include <QObject>
+#include <QVector>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QNetworkAccessManager;
+
+/**
+ * @class EndpointSelector
+ * @brief Выбор адреса API среди нескольких серверов
+ *
+ * Для каждого сервера ведет сглаженную (EWMA) задержку и признак доступности.
+ * Запросы направляются на доступный сервер с наименьшей задержкой; недоступные
+ * серверы периодически проверяются в фоне и возвращаются в работу.
+ * Один объект можно разделить между несколькими обертками на одном
+ * транспорте: статистика и фоновые проверки у них будут общими.
+ */
+class EndpointSelector : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @param manager Менеджер сетевых запросов для фоновых проверок
+     * @param parent Родительский объект Qt
+     */
+    explicit EndpointSelector(QNetworkAccessManager* manager, QObject* parent = nullptr);
+
+    /**
+     * @brief Задает список серверов
+     * @param urls Базовые URL API, например "http://127.0.0.1:8080"
+     */
+    void setEndpoints(const QStringList& urls);
+
+    QStringList endpoints() const;
+
+    int count() const;
+
+    /**
+     * @brief Выбирает сервер для очередного запроса
+     * @return Доступный сервер с наименьшей задержкой; если доступных нет -
+     *         сервер, дольше всех не отказывавший
+     */
+    QString select() const;
+
+    /**
+     * @brief Выбирает сервер, отдавая предпочтение заданному
+     *
+     * Нужен запросам аутентификации, привязанным к серверу, выдавшему токены.
+     * @param url Предпочтительный сервер
+     * @return url, пока он в списке и доступен; иначе select()
+     */
+    QString selectPreferring(const QString& url) const;
+
+    /**
+     * @brief Учитывает успешный ответ сервера
+     * @param url Сервер
+     * @param latencyMs Время ответа
+     */
+    void reportSuccess(const QString& url, double latencyMs);
+
+    /**
+     * @brief Помечает сервер недоступным после ошибки соединения
+     */
+    void reportFailure(const QString& url);
+
+    /**
+     * @brief Задает период фоновой проверки серверов
+     *
+     * Проверка - дешевый GET корня сервера; любой HTTP-ответ считается успехом.
+     */
+    void setHealthCheckInterval(int ms);
+
+signals:
+    /**
+     * @brief Сигнал изменения доступности сервера
+     */
+    void endpointStateChanged(const QString& url, bool healthy);
+
+private:
+    /// Состояние одного сервера
+    struct Endpoint {
+        QString url;
+        double ewmaMs = -1.0;    ///< Сглаженная задержка (-1 - еще не измерена)
+        bool healthy = true;
+        qint64 lastFailureMs = -1;
+        bool checking = false;   ///< Идет фоновая проверка
+    };
+
+    QNetworkAccessManager* manager;
+    QVector<Endpoint> items;
+    QTimer healthTimer;
+    QElapsedTimer clock;
+
+    Endpoint* find(const QString& url);
+    void runHealthChecks();
+    void setHealthy(Endpoint& endpoint, bool healthy);
+};
+
+#endif // ENDPOINTSELECTOR_H
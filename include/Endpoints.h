@@ -0,0 +1,154 @@
+// Файл: Endpoints.h
+#ifndef ENDPOINTS_H
+#define ENDPOINTS_H
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QString>
+#include <QUrl>
+#include <charconv>
+#include <type_traits>
+#include "AuthHandler.h"
+#include "CoursesHandler.h"
+#include "RegistrationHandler.h"
+#include "TopicHandler.h"
+
+/**
+ * @namespace Api
+ * @brief Таблица конечных точек API, известная на этапе компиляции
+ *
+ * Каждая конечная точка - тип с методом, шаблоном пути, требованием
+ * авторизации, идемпотентностью и обработчиком ответа. Запросы
+ * строятся и разбираются по этим описаниям без поиска во время работы:
+ * CNetworkWrapper::decodeReply<E> создает обработчик E::Decoder и подключает
+ * его сигналы перегрузкой bindHandler, выбранной при компиляции, а
+ * CNetworkWrapper::decodePage<E> так же разбирает страницы списков.
+ * Места для идентификаторов в пути обозначаются "{}".
+ */
+namespace Api {
+
+/// HTTP-метод запроса
+enum class Method { Get, Post };
+
+/// Нужен ли запросу токен доступа
+enum class Access { Public, Bearer };
+
+/// Можно ли повторить запрос на другом сервере
+enum class Idempotency { Idempotent, NonIdempotent };
+
+/**
+ * @struct Endpoint
+ * @brief Общая часть описания конечной точки
+ * @tparam Handler Обработчик ответа (void - ответ разбирается отдельно)
+ */
+template <Method M, Access A, Idempotency I, typename Handler>
+struct Endpoint {
+    static constexpr Method method = M;
+    static constexpr Access access = A;
+    static constexpr bool idempotent = I == Idempotency::Idempotent;
+    using Decoder = Handler;
+};
+
+// Новая конечная точка - одна строка
+struct Login        : Endpoint<Method::Post, Access::Public, Idempotency::NonIdempotent, AuthHandler>         { static constexpr char path[] = "/api/auth/login/"; };
+struct Register     : Endpoint<Method::Post, Access::Public, Idempotency::NonIdempotent, RegistrationHandler> { static constexpr char path[] = "/api/auth/register/"; };
+struct Refresh      : Endpoint<Method::Post, Access::Public, Idempotency::NonIdempotent, AuthHandler>         { static constexpr char path[] = "/api/auth/refresh/"; };
+struct Courses      : Endpoint<Method::Get,  Access::Bearer, Idempotency::Idempotent,    CoursesHandler>      { static constexpr char path[] = "/api/courses/courses"; };
+struct CourseTopics : Endpoint<Method::Get,  Access::Bearer, Idempotency::Idempotent,    TopicHandler>        { static constexpr char path[] = "/api/courses/{}/themes/"; };
+struct Subtopics    : Endpoint<Method::Get,  Access::Bearer, Idempotency::Idempotent,    TopicHandler>        { static constexpr char path[] = "/api/courses/{}/themes/{}/"; };
+struct ChangeEvents : Endpoint<Method::Get,  Access::Bearer, Idempotency::Idempotent,    void>                { static constexpr char path[] = "/api/courses/events/"; };
+
+/**
+ * @brief Ключ, под которым обработчик ждет список, пришедший голым массивом
+ *
+ * nullptr - обработчик списков не принимает.
+ */
+template <typename Handler> inline constexpr const char* listKey = nullptr;
+template <> inline constexpr const char* listKey<CoursesHandler> = "courses";
+template <> inline constexpr const char* listKey<TopicHandler> = "subtopics";
+
+/**
+ * @brief Приводит ответ конечной точки к объекту, который ждет ее обработчик
+ *
+ * Голый массив оборачивается под ключом listKey обработчика.
+ */
+template <typename E>
+QJsonObject responseObject(const QJsonDocument& doc) {
+    if constexpr (listKey<typename E::Decoder> != nullptr) {
+        if (doc.isArray()) {
+            return QJsonObject{{QLatin1String(listKey<typename E::Decoder>), doc.array()}};
+        }
+    }
+    return doc.object();
+}
+
+/**
+ * @brief Считает места для идентификаторов в шаблоне пути
+ */
+constexpr int placeholderCount(const char* path) {
+    int count = 0;
+    for (; *path; ++path) {
+        if (path[0] == '{' && path[1] == '}') {
+            ++count;
+            ++path;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Собирает путь конечной точки, подставляя идентификаторы
+ * @param ids Идентификаторы в порядке их мест в шаблоне
+ * @return Путь относительно адреса сервера
+ *
+ * Число аргументов проверяется при компиляции; строка выделяется один раз.
+ */
+template <typename E, typename... Ids>
+QByteArray path(Ids... ids) {
+    static_assert(placeholderCount(E::path) == int(sizeof...(Ids)),
+                  "Number of ids does not match the endpoint path template");
+    static_assert((std::is_integral_v<Ids> && ...), "Endpoint ids must be integers");
+
+    const long long values[] = {static_cast<long long>(ids)..., 0};
+    // 20 знаков хватает на любое 64-битное число
+    QByteArray result;
+    result.reserve(int(sizeof(E::path)) + int(sizeof...(Ids)) * 20);
+
+    int next = 0;
+    for (const char* p = E::path; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}') {
+            char digits[20];
+            const auto converted = std::to_chars(digits, digits + sizeof(digits), values[next++]);
+            result.append(digits, int(converted.ptr - digits));
+            ++p;
+        } else {
+            result.append(*p);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Создает запрос к конечной точке
+ * @param baseUrl Адрес сервера
+ * @param bearer Готовый заголовок Authorization (используется, если нужен)
+ * @param ids Идентификаторы для шаблона пути
+ */
+template <typename E, typename... Ids>
+QNetworkRequest request(const QString& baseUrl, const QByteArray& bearer, Ids... ids) {
+    QNetworkRequest request(QUrl(baseUrl + QLatin1String(path<E>(ids...))));
+    if constexpr (E::access == Access::Bearer) {
+        request.setRawHeader("Authorization", bearer);
+    }
+    if constexpr (E::method == Method::Post) {
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    }
+    return request;
+}
+
+} // namespace Api
+
+#endif // ENDPOINTS_H
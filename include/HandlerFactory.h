@@ -7,15 +7,18 @@
 /**
  * @class HandlerFactory
  * @brief Фабрика для создания обработчиков ответов
+ *
+ * Обработчики успешных ответов выбираются по описанию конечной точки
+ * (см. Endpoints.h); фабрика распознает только ответы-ошибки.
  */
 class HandlerFactory {
 public:
     /**
-     * @brief Создает обработчик на основе типа ответа
-     * @param endpoint - URL конечной точки API
-     * @return Указатель на обработчик или nullptr
+     * @brief Создает обработчик, если ответ содержит ошибку
+     * @param response Ответ сервера
+     * @return ErrorHandler или nullptr
      */
-    static ResponseHandler* createHandler(const QJsonObject& response);
+    static ResponseHandler* createErrorHandler(const QJsonObject& response);
 };
 
 #endif // HANDLERFACTORY_H
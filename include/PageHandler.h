@@ -0,0 +1,43 @@
+// Файл: PageHandler.h
+#ifndef PAGEHANDLER_H
+#define PAGEHANDLER_H
+
+#include "ResponseHandler.h"
+#include <QJsonObject>
+#include <QJsonArray>
+
+/**
+ * @class PageHandler
+ * @brief Обработчик одной страницы постраничного списка
+ *
+ * Понимает как ответы вида {"count", "next", "results"}, так и голый
+ * массив (обернутый в "courses") или объект темы с "subtopics".
+ * Массив длиннее запрошенной страницы считается списком от сервера без
+ * постраничной выдачи: из него берется только окно [offset, offset + limit).
+ */
+class PageHandler : public ResponseHandler {
+    Q_OBJECT
+public:
+    /**
+     * @param offset Смещение первого элемента страницы
+     * @param limit Запрошенный размер страницы
+     */
+    explicit PageHandler(int offset, int limit, QObject* parent = nullptr);
+
+    void process(const QJsonObject& response) override;
+
+signals:
+    /**
+     * @brief Сигнал получения страницы
+     * @param offset Смещение первого элемента страницы
+     * @param items Элементы страницы
+     * @param totalCount Общее число элементов или -1, если оно еще неизвестно
+     */
+    void pageReceived(int offset, const QJsonArray& items, int totalCount);
+
+private:
+    int m_offset;
+    int m_limit;
+};
+
+#endif // PAGEHANDLER_H
@@ -0,0 +1,149 @@
+// Файл: PagedListing.h
+#ifndef PAGEDLISTING_H
+#define PAGEDLISTING_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QJsonObject>
+
+class CNetworkWrapper;
+
+/**
+ * @class PagedListing
+ * @brief Ленивый постраничный список курсов или тем
+ *
+ * Загружает страницы по мере прокрутки, заранее запрашивает следующую
+ * страницу и держит в памяти только скользящее окно вокруг текущей
+ * позиции, поэтому время до первого результата и расход памяти
+ * не зависят от размера каталога.
+ *
+ * Уведомления об изменениях (CNetworkWrapper::subscribeChanges()) обновляют
+ * загруженные элементы на месте, изменения незагруженных игнорируются;
+ * создание и удаление сдвигают позиции, поэтому окно сбрасывается и
+ * текущая страница загружается заново.
+ * Ответы на запросы, отправленные до сброса, отбрасываются по номеру запроса.
+ */
+class PagedListing : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Конструктор класса
+     * @param network Сетевая обертка, через которую загружаются страницы
+     * @param pageSize Размер страницы
+     * @param windowPages Сколько страниц держать в памяти (не меньше 2)
+     * @param parent Родительский объект Qt
+     */
+    explicit PagedListing(CNetworkWrapper* network, int pageSize = 50,
+                          int windowPages = 3, QObject* parent = nullptr);
+
+    /**
+     * @brief Переключает список на курсы
+     */
+    void setCoursesSource();
+
+    /**
+     * @brief Переключает список на подтемы
+     * @param courseId Идентификатор курса
+     * @param parentTopicId Родительская тема (-1 для корневых тем)
+     */
+    void setTopicsSource(int courseId, int parentTopicId = -1);
+
+    /**
+     * @brief Сообщает, что пользователь дошел до элемента с индексом index
+     *
+     * Загружает страницу с этим элементом и следующую за ней,
+     * выгружает страницы вне окна.
+     */
+    void ensureLoaded(int index);
+
+    /**
+     * @brief Проверяет, загружен ли элемент
+     */
+    bool isLoaded(int index) const;
+
+    /**
+     * @brief Возвращает элемент списка
+     * @return Элемент или QJsonValue::Undefined, если страница не загружена
+     */
+    QJsonValue itemAt(int index) const;
+
+    /**
+     * @brief Общее число элементов
+     * @return Количество или -1, если конец списка еще не известен
+     */
+    int totalCount() const;
+
+    int pageSize() const;
+
+signals:
+    /**
+     * @brief Сигнал загрузки страницы
+     * @param firstIndex Индекс первого элемента страницы
+     * @param items Элементы страницы
+     */
+    void pageLoaded(int firstIndex, const QJsonArray& items);
+
+    /**
+     * @brief Сигнал выгрузки страницы из окна
+     * @param firstIndex Индекс первого элемента страницы
+     * @param count Количество выгруженных элементов
+     */
+    void pageEvicted(int firstIndex, int count);
+
+    /**
+     * @brief Сигнал изменения общего числа элементов
+     */
+    void totalCountChanged(int totalCount);
+
+    /**
+     * @brief Сигнал неудачной загрузки страницы
+     *
+     * Страница снова может быть запрошена через ensureLoaded().
+     * @param firstIndex Индекс первого элемента страницы
+     */
+    void pageFailed(int firstIndex);
+
+    /**
+     * @brief Сигнал изменения загруженного элемента
+     * @param index Индекс элемента
+     * @param item Новые данные элемента
+     */
+    void itemChanged(int index, const QJsonValue& item);
+
+    /**
+     * @brief Сигнал сброса списка: позиции элементов изменились
+     *
+     * Загруженные страницы отброшены; текущая запрошена заново.
+     */
+    void invalidated();
+
+private:
+    enum class Source { None, Courses, Topics };
+
+    CNetworkWrapper* network;   ///< Сетевая обертка
+    int m_pageSize;             ///< Размер страницы
+    int windowPages;            ///< Размер окна в страницах
+    Source source = Source::None;
+    int courseId = -1;
+    int parentTopicId = -1;
+    int currentPage = 0;        ///< Страница, на которой находится пользователь
+    int total = -1;             ///< Общее число элементов
+    QMap<int, QJsonArray> pages;  ///< Загруженные страницы окна
+    QHash<int, quint64> pendingPages;  ///< Отправленные запросы: страница -> номер запроса
+
+    void reset(Source newSource);
+    void requestPage(int page);
+    bool takePending(int offset, quint64 requestId);
+    void onPageReceived(int offset, const QJsonArray& items, int totalCount, quint64 requestId);
+    void onPageFailed(int offset, quint64 requestId);
+    void onItemChanged(const QJsonObject& item, bool created);
+    void onItemRemoved(int id);
+    void invalidate();
+    bool inWindow(int page) const;
+    void evictOutsideWindow();
+};
+
+#endif // PAGEDLISTING_H
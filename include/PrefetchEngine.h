@@ -0,0 +1,181 @@
+// Файл: PrefetchEngine.h
+#ifndef PREFETCHENGINE_H
+#define PREFETCHENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QQueue>
+#include <QPair>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+#include <QThreadPool>
+
+class CNetworkWrapper;
+
+/**
+ * @class PrefetchEngine
+ * @brief Упреждающая загрузка корневых тем наиболее вероятных курсов
+ *
+ * После получения списка курсов заранее запрашивает с низким приоритетом
+ * корневые темы курсов, которые пользователь чаще и недавнее открывал.
+ * История открытий ведется отдельно для каждой учетной записи и хранится
+ * в файле JSON; чтение и запись идут в фоновом потоке. Пока истории нет,
+ * кандидаты выбираются по порядку курсов в каталоге. Соблюдает бюджет
+ * запросов и трафика; интерактивные запросы обертки отменяют упреждающие.
+ * Подключается через CNetworkWrapper::setPrefetchEngine().
+ */
+class PrefetchEngine : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @struct Stats
+     * @brief Статистика эффективности упреждающей загрузки
+     */
+    struct Stats {
+        int issued = 0;     ///< Отправлено упреждающих запросов
+        int hits = 0;       ///< Открытия курса, обслуженные из кэша
+        int misses = 0;     ///< Открытия курса, ушедшие в сеть
+        int wasted = 0;     ///< Загружено, но не пригодилось
+        int cancelled = 0;  ///< Отменено интерактивными запросами
+        qint64 bytes = 0;   ///< Трафик упреждающих запросов
+
+        double hitRate() const { return hits + misses ? double(hits) / (hits + misses) : 0.0; }
+    };
+
+    /**
+     * @brief Конструктор класса
+     *
+     * История открытий по умолчанию хранится в каталоге "prefetch"
+     * внутри AppLocalDataLocation.
+     * @param network Сетевая обертка, через которую выполняются запросы
+     * @param parent Родительский объект Qt
+     */
+    explicit PrefetchEngine(CNetworkWrapper* network, QObject* parent = nullptr);
+
+    /**
+     * @brief Дожидается записи истории открытий
+     */
+    ~PrefetchEngine() override;
+
+    /**
+     * @brief Задает каталог файлов истории открытий
+     * @param dir Каталог; пустая строка - историю не сохранять
+     */
+    void setHistoryDirectory(const QString& dir);
+
+    /**
+     * @brief Сколько самых вероятных курсов держать загруженными
+     */
+    void setMaxCandidates(int count);
+
+    /**
+     * @brief Задает бюджет упреждающих запросов
+     * @param maxRequests Максимум запросов за окно
+     * @param maxBytes Максимум трафика за окно
+     * @param windowMs Длина окна в миллисекундах
+     */
+    void setBudget(int maxRequests, qint64 maxBytes, int windowMs);
+
+    /**
+     * @brief Задает срок жизни загруженных заранее данных
+     */
+    void setCacheTtl(int ttlMs);
+
+    /**
+     * @brief Возвращает текущую статистику
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Отдает заранее загруженные корневые темы курса
+     *
+     * Вызывается оберткой при интерактивном открытии курса; учитывает
+     * обращение в истории и засчитывает попадание или промах.
+     * @return true, если темы были в кэше
+     */
+    bool takePrefetched(int courseId, QJsonArray& subtopics);
+
+    /**
+     * @brief Сохраняет результат упреждающего запроса
+     */
+    void storePrefetched(int courseId, const QJsonArray& subtopics, qint64 bytes);
+
+    /**
+     * @brief Сообщает о неудачном или отмененном упреждающем запросе
+     */
+    void prefetchFailed(int courseId, bool cancelled);
+
+    /**
+     * @brief Забывает загруженные заранее темы курса, если они устарели
+     */
+    void invalidate(int courseId);
+
+    /**
+     * @brief Забывает все загруженные заранее темы и активные запросы
+     *
+     * Вызывается при выходе из сессии: данные и отмененные запросы прежнего
+     * пользователя не должны попасть к следующему. История открытий
+     * сохраняется в файл пользователя и выгружается из памяти.
+     */
+    void clear();
+
+signals:
+    /**
+     * @brief Сигнал изменения статистики
+     */
+    void statsChanged(const PrefetchEngine::Stats& stats);
+
+private:
+    /// История обращений к курсу
+    struct Access {
+        double score = 0.0;     ///< Частота, затухающая со временем
+        qint64 lastAccessMs = 0; ///< Время последнего открытия (мс с начала эпохи)
+    };
+
+    /// Загруженные заранее темы
+    struct CacheEntry {
+        QJsonArray subtopics;
+        qint64 storedMs = 0;
+    };
+
+    CNetworkWrapper* network;
+    QString historyDir;                   ///< Каталог файлов истории
+    QString historyUser;                  ///< Чья история сейчас в памяти
+    bool historyDirty = false;            ///< История изменилась после записи
+    QThreadPool worker;                   ///< Один поток: операции с файлами идут по очереди
+    QTimer saveTimer;                     ///< Отложенная запись истории
+    QElapsedTimer clock;
+    int maxCandidates = 3;
+    int maxRequests = 10;
+    qint64 maxBytes = 1024 * 1024;
+    int windowMs = 60000;
+    int cacheTtlMs = 5 * 60000;
+
+    QList<int> knownCourses;              ///< Курсы из последнего списка
+    QHash<int, Access> history;           ///< История открытий курсов
+    QHash<int, CacheEntry> cache;         ///< Загруженные заранее темы
+    QHash<int, qint64> servedAt;          ///< Когда курс открывали интерактивно
+    QSet<int> inFlight;                   ///< Курсы с активным упреждающим запросом
+    QQueue<qint64> issuedAt;              ///< Время отправки запросов в окне бюджета
+    QQueue<QPair<qint64, qint64>> received;  ///< Время и объем ответов в окне бюджета
+    Stats counters;
+
+    double rank(int courseId, qint64 nowMs) const;
+    void switchUser(const QString& user);
+    void applyHistory(const QString& user, const QHash<int, Access>& loaded);
+    void flushHistory();
+    QString historyPath(const QString& user) const;
+    static double decayed(const Access& access, qint64 nowMs);
+    static QHash<int, Access> readHistory(const QString& path);
+    static bool writeHistory(const QString& path, const QHash<int, Access>& entries);
+    void addCourses(const QJsonArray& courses);
+    void schedule();
+    bool budgetAllows(qint64 now);
+    void expireCache(qint64 now);
+};
+
+#endif // PREFETCHENGINE_H
@@ -0,0 +1,188 @@
+// Файл: SearchIndex.h
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QJsonArray>
+#include <QTimer>
+#include <QThreadPool>
+
+/**
+ * @class SearchIndex
+ * @brief Локальный полнотекстовый индекс курсов, тем и материалов
+ *
+ * Обратный индекс со словарем, упорядоченным по словам: поиск по префиксу -
+ * это один lowerBound, нечеткий поиск перебирает только слова с той же
+ * первой буквой и близкой длиной. Индекс обновляется по мере разбора ответов
+ * и может сохраняться на диск, чтобы быть доступным сразу после запуска.
+ */
+class SearchIndex : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Тип записи индекса
+     */
+    enum class EntryKind : quint8 { Course, Topic, Material };
+
+    /**
+     * @struct Result
+     * @brief Результат поиска
+     */
+    struct Result {
+        EntryKind kind;  ///< Тип найденной записи
+        int id;          ///< Идентификатор записи
+        QString title;   ///< Заголовок записи
+        double score;    ///< Релевантность (больше - лучше)
+    };
+
+    explicit SearchIndex(QObject* parent = nullptr);
+
+    /**
+     * @brief Дожидается завершения фоновых операций с файлом
+     */
+    ~SearchIndex() override;
+
+    /**
+     * @brief Добавляет или заменяет запись
+     * @param kind Тип записи
+     * @param id Идентификатор записи
+     * @param title Заголовок (слова заголовка весят больше)
+     * @param text Дополнительный текст, например описание
+     */
+    void upsert(EntryKind kind, int id, const QString& title, const QString& text = QString());
+
+    /**
+     * @brief Удаляет запись из индекса
+     */
+    void remove(EntryKind kind, int id);
+
+    /**
+     * @brief Индексирует курсы из ответа сервера
+     */
+    void indexCourses(const QJsonArray& courses);
+
+    /**
+     * @brief Индексирует темы из ответа сервера, включая вложенные подтемы
+     */
+    void indexTopics(const QJsonArray& topics);
+
+    /**
+     * @brief Индексирует материалы из ответа сервера
+     */
+    void indexMaterials(const QJsonArray& materials);
+
+    /**
+     * @brief Ищет записи по запросу
+     *
+     * Каждое слово запроса должно совпасть точно, по префиксу или
+     * с опечаткой; результаты отсортированы по релевантности. Для очень
+     * частых префиксов просматриваются только самые близкие слова словаря.
+     * @param query Строка запроса
+     * @param limit Максимальное число результатов
+     */
+    QVector<Result> search(const QString& query, int limit = 20) const;
+
+    /**
+     * @brief Количество записей в индексе
+     */
+    int size() const;
+
+    /**
+     * @brief Очищает индекс
+     */
+    void clear();
+
+    /**
+     * @brief Задает файл индекса и загружает из него сохраненные данные
+     *
+     * Файл читается в фоновом потоке; записи, добавленные до окончания
+     * загрузки, не перезаписываются сохраненными. После этого изменения
+     * сохраняются в файл с задержкой, объединяя частые обновления в одну
+     * запись; запись тоже выполняется в фоне.
+     * @param path Путь к файлу индекса
+     */
+    void setStoragePath(const QString& path);
+
+    /**
+     * @brief Идет ли фоновая загрузка файла индекса
+     */
+    bool isLoading() const;
+
+    /**
+     * @brief Сохраняет индекс в файл атомарно
+     *
+     * Выполняется синхронно; отложенное сохранение в файл из
+     * setStoragePath() идет в фоновом потоке.
+     * @return true при успешной записи
+     */
+    bool save(const QString& path) const;
+
+    /**
+     * @brief Загружает индекс из файла, заменяя текущие данные
+     *
+     * Выполняется синхронно, в отличие от загрузки в setStoragePath().
+     * @return true при успешном чтении
+     */
+    bool load(const QString& path);
+
+signals:
+    /**
+     * @brief Сигнал изменения индекса
+     */
+    void indexChanged();
+
+    /**
+     * @brief Сигнал завершения фоновой загрузки файла индекса
+     * @param ok false, если файл есть, но прочитать его не удалось
+     */
+    void storageLoaded(bool ok);
+
+private:
+    /// Слово записи и его вес
+    struct Term {
+        QString word;
+        float weight;
+    };
+
+    /// Запись индекса
+    struct Document {
+        EntryKind kind;
+        int id;
+        QString title;
+        QVector<Term> terms;
+    };
+
+    using Postings = QMap<QString, QHash<quint64, float>>;
+
+    /// Слово словаря, подходящее к слову запроса
+    struct Match {
+        const QHash<quint64, float>* docs;  ///< Записи со словом и их веса
+        double factor;                      ///< Близость слова к запросу
+    };
+
+    QHash<quint64, Document> documents;              ///< Записи по ключу
+    Postings postings;                               ///< Слово -> записи с весами
+    QString storagePath;                             ///< Файл для сохранения
+    QTimer saveTimer;                                ///< Отложенное сохранение
+    QThreadPool worker;                              ///< Один поток для операций с файлом
+    bool loading = false;                            ///< Идет фоновая загрузка
+    quint64 generation = 0;                          ///< Меняется при clear()
+
+    static quint64 key(EntryKind kind, int id);
+    static QStringList tokenize(const QString& text);
+    static int boundedDistance(const QString& a, const QString& b, int maxDistance);
+    static bool readFile(const QString& path, QHash<quint64, Document>& documents, Postings& postings);
+    static bool writeFile(const QString& path, const QHash<quint64, Document>& documents);
+
+    void insertDocument(quint64 docKey, const Document& document);
+    void removeDocument(quint64 docKey);
+    QVector<Match> matchToken(const QString& token) const;
+    void scheduleSave();
+    void saveInBackground();
+    void applyLoaded(const QHash<quint64, Document>& loaded, const Postings& loadedPostings);
+};
+
+#endif // SEARCHINDEX_H
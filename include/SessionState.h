@@ -0,0 +1,38 @@
+// Файл: SessionState.h
+#ifndef SESSIONSTATE_H
+#define SESSIONSTATE_H
+
+#include <QString>
+
+/**
+ * @struct SessionState
+ * @brief Состояние одной пользовательской сессии
+ *
+ * Вынесено из CNetworkWrapper, чтобы несколько независимых сессий
+ * могли работать поверх одного сетевого транспорта.
+ */
+struct SessionState {
+    QString accessToken;   ///< Текущий токен доступа
+    QString refreshToken;  ///< Токен для обновления сессии
+    QString userRole;      ///< Роль текущего пользователя
+    QString userName;      ///< Учетная запись (email), под которой выполнен вход
+
+    /**
+     * @brief Проверяет, что есть оба токена
+     */
+    bool isActive() const {
+        return !accessToken.isEmpty() && !refreshToken.isEmpty();
+    }
+
+    /**
+     * @brief Сбрасывает состояние сессии
+     */
+    void clear() {
+        accessToken.clear();
+        refreshToken.clear();
+        userRole.clear();
+        userName.clear();
+    }
+};
+
+#endif // SESSIONSTATE_H
@@ -0,0 +1,50 @@
+// Файл: SessionStore.h
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include <QObject>
+#include "SessionState.h"
+
+/**
+ * @class SessionStore
+ * @brief Базовый класс хранилища токенов сессии
+ *
+ * Реализации могут работать как синхронно, так и в фоне: результат
+ * загрузки всегда приходит сигналом loaded().
+ */
+class SessionStore : public QObject {
+    Q_OBJECT
+public:
+    explicit SessionStore(QObject* parent = nullptr) : QObject(parent) {}
+
+    /**
+     * @brief Запускает загрузку сохраненной сессии
+     */
+    virtual void load() = 0;
+
+    /**
+     * @brief Сохраняет состояние сессии
+     * @param state Токены и роль пользователя
+     */
+    virtual void save(const SessionState& state) = 0;
+
+    /**
+     * @brief Удаляет сохраненную сессию
+     */
+    virtual void clear() = 0;
+
+signals:
+    /**
+     * @brief Сигнал завершения загрузки
+     * @param state Загруженная сессия (пустая, если ничего не сохранено)
+     */
+    void loaded(const SessionState& state);
+
+    /**
+     * @brief Сигнал ошибки чтения или записи хранилища
+     * @param message Описание ошибки
+     */
+    void error(const QString& message);
+};
+
+#endif // SESSIONSTORE_H
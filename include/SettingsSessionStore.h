@@ -0,0 +1,31 @@
+// Файл: SettingsSessionStore.h
+#ifndef SETTINGSSESSIONSTORE_H
+#define SETTINGSSESSIONSTORE_H
+
+#include "SessionStore.h"
+#include <QString>
+
+/**
+ * @class SettingsSessionStore
+ * @brief Синхронное хранилище сессии в группе QSettings
+ *
+ * Прежний способ хранения токенов; все операции выполняются
+ * в вызывающем потоке.
+ */
+class SettingsSessionStore : public SessionStore {
+    Q_OBJECT
+public:
+    /**
+     * @param group Группа QSettings, например "auth"
+     */
+    explicit SettingsSessionStore(const QString& group, QObject* parent = nullptr);
+
+    void load() override;
+    void save(const SessionState& state) override;
+    void clear() override;
+
+private:
+    QString m_group;
+};
+
+#endif // SETTINGSSESSIONSTORE_H
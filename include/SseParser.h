@@ -0,0 +1,65 @@
+// Файл: SseParser.h
+#ifndef SSEPARSER_H
+#define SSEPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/**
+ * @struct SseEvent
+ * @brief Событие потока Server-Sent Events
+ */
+struct SseEvent {
+    QString id;        ///< Идентификатор последнего события (для Last-Event-ID)
+    QString type;      ///< Тип события (поле event), по умолчанию "message"
+    QString data;      ///< Данные события
+};
+
+/**
+ * @class SseParser
+ * @brief Инкрементальный разбор потока text/event-stream
+ *
+ * Принимает данные кусками по мере прихода в readyRead и возвращает
+ * полностью полученные события.
+ */
+class SseParser {
+public:
+    /**
+     * @brief Добавляет очередной кусок потока
+     * @param chunk Данные из сети
+     * @return События, завершенные этим куском
+     */
+    QVector<SseEvent> feed(const QByteArray& chunk);
+
+    /**
+     * @brief Сбрасывает незавершенное событие (при переподключении)
+     */
+    void reset();
+
+    /**
+     * @brief Забывает идентификатор последнего события
+     *
+     * reset() его сохраняет, чтобы поток продолжился с того же места;
+     * при смене пользователя продолжать нечего.
+     */
+    void clearLastEventId();
+
+    /**
+     * @brief Задержка переподключения, заданная сервером полем retry
+     * @return Миллисекунды или -1, если сервер ее не задавал
+     */
+    int retryInterval() const;
+
+private:
+    QByteArray buffer;        ///< Неразобранный остаток потока
+    QString eventType;
+    QString data;
+    bool hasData = false;
+    QString lastEventId;      ///< Сохраняется между событиями
+    int retryMs = -1;         ///< Действует до следующего поля retry
+
+    void processLine(const QByteArray& line, QVector<SseEvent>& events);
+};
+
+#endif // SSEPARSER_H
@@ -0,0 +1,134 @@
+// Файл: TopicGraph.h
+#ifndef TOPICGRAPH_H
+#define TOPICGRAPH_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QSet>
+#include <QJsonObject>
+#include <QJsonArray>
+
+/**
+ * @struct TopicNode
+ * @brief Узел дерева тем
+ */
+struct TopicNode {
+    int id = -1;            ///< Идентификатор темы
+    int courseId = -1;      ///< Курс, к которому относится тема
+    int parentId = -1;      ///< Родительская тема (-1 для корневых тем курса)
+    QJsonObject data;       ///< Поля темы без вложенных подтем и материалов
+    QVector<int> children;  ///< Идентификаторы подтем в порядке сервера
+    QJsonArray materials;   ///< Материалы темы
+    bool alive = false;     ///< false для освобожденных ячеек хранилища
+    bool placeholder = false; ///< Тема известна только по своим подтемам; ее данные и место в дереве еще не загружены
+};
+
+/**
+ * @class TopicGraph
+ * @brief Общее дерево тем с поиском по идентификатору за O(1)
+ *
+ * Узлы хранятся подряд в одном массиве и индексируются по id.
+ * Ответы TopicHandler применяются инкрементально: сигналы сообщают
+ * только о тех темах, которые действительно изменились. Подтемы еще
+ * не загруженной темы не теряются: для нее создается узел-заглушка
+ * (TopicNode::placeholder), который заполнится, когда тема придет
+ * в списке своего родителя.
+ */
+class TopicGraph : public QObject {
+    Q_OBJECT
+public:
+    explicit TopicGraph(QObject* parent = nullptr);
+
+    /**
+     * @brief Возвращает узел темы
+     * @return Указатель на узел или nullptr, если тема неизвестна.
+     *         Указатель действителен до следующего изменения графа.
+     */
+    const TopicNode* node(int topicId) const;
+
+    bool contains(int topicId) const;
+
+    /**
+     * @brief Возвращает подтемы темы
+     */
+    QVector<int> children(int topicId) const;
+
+    /**
+     * @brief Возвращает корневые темы курса
+     */
+    QVector<int> rootTopics(int courseId) const;
+
+    /**
+     * @brief Возвращает материалы темы
+     */
+    QJsonArray materials(int topicId) const;
+
+    /**
+     * @brief Количество тем в графе
+     */
+    int size() const;
+
+    /**
+     * @brief Применяет список подтем, полученный с сервера
+     * @param courseId Идентификатор курса
+     * @param parentTopicId Родительская тема (-1 для корневых тем)
+     * @param subtopics Подтемы в формате JSON
+     * @param complete true, если это полный список и отсутствующие
+     *        в нем подтемы нужно удалить; false для отдельной страницы
+     */
+    void applySubtopics(int courseId, int parentTopicId, const QJsonArray& subtopics,
+                        bool complete = true);
+
+    /**
+     * @brief Применяет материалы темы
+     */
+    void applyMaterials(int topicId, const QJsonArray& materials);
+
+    /**
+     * @brief Удаляет тему вместе с поддеревом
+     */
+    void removeTopic(int topicId);
+
+    /**
+     * @brief Очищает граф
+     */
+    void clear();
+
+signals:
+    /**
+     * @brief Сигнал изменения поддерева
+     * @param courseId Идентификатор курса
+     * @param rootTopicId Тема, поддерево которой изменилось (-1 - корень курса)
+     * @param changedTopicIds Добавленные или измененные темы
+     */
+    void subtreeChanged(int courseId, int rootTopicId, const QVector<int>& changedTopicIds);
+
+    /**
+     * @brief Сигнал удаления тем
+     * @param topicIds Удаленные темы, включая поддеревья
+     */
+    void topicsRemoved(const QVector<int>& topicIds);
+
+    /**
+     * @brief Сигнал изменения материалов темы
+     */
+    void materialsChanged(int topicId);
+
+private:
+    QVector<TopicNode> nodes;              ///< Узлы, хранящиеся подряд
+    QHash<int, int> indexById;             ///< id темы -> позиция в nodes
+    QVector<int> freeSlots;                ///< Освобожденные позиции nodes
+    QHash<int, QVector<int>> courseRoots;  ///< Корневые темы курсов
+
+    TopicNode* find(int topicId);
+    QVector<int>* childList(int courseId, int parentTopicId);
+    int allocate();
+    void mergeSubtopics(int courseId, int parentTopicId, const QJsonArray& subtopics,
+                        bool complete, QVector<int>& changed, QVector<int>& dropped,
+                        QSet<int>& seen);
+    void detach(int topicId, QVector<int>& removed);
+    void moveToCourse(int topicId, int courseId, QVector<int>& changed);
+};
+
+#endif // TOPICGRAPH_H
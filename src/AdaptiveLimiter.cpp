@@ -0,0 +1,202 @@
+#include "AdaptiveLimiter.h"
+#include <QNetworkReply>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const int kSampleWindow = 50;       ///< Сколько последних задержек учитывать
+const int kMinSamples = 10;         ///< Меньше замеров - p95 не считаем
+const double kDecreaseFactor = 0.7;
+const qint64 kDecreaseCooldownMs = 1000;  ///< Не снижать лимит чаще раза в секунду
+const qint64 kMaxRetryAfterMs = 5 * 60000;
+}
+
+AdaptiveLimiter::AdaptiveLimiter(QObject* parent)
+    : QObject(parent),
+      resumeTimer(this)
+{
+    clock.start();
+    samples.reserve(kSampleWindow);
+    resumeTimer.setSingleShot(true);
+    connect(&resumeTimer, &QTimer::timeout, this, &AdaptiveLimiter::pump);
+}
+
+void AdaptiveLimiter::submit(StartFunction start, bool lowPriority, std::function<void()> onDropped) {
+    if (lowPriority) {
+        background.enqueue({std::move(start), std::move(onDropped)});
+    } else {
+        interactive.enqueue({std::move(start), std::move(onDropped)});
+    }
+    pump();
+}
+
+void AdaptiveLimiter::dropLowPriority() {
+    QQueue<Pending> dropped;
+    dropped.swap(background);
+    for (const Pending& pending : dropped) {
+        if (pending.onDropped) {
+            pending.onDropped();
+        }
+    }
+}
+
+void AdaptiveLimiter::setLimits(int minLimit, int maxLimit) {
+    this->minLimit = qMax(1, minLimit);
+    this->maxLimit = qMax(this->minLimit, maxLimit);
+    setLimit(limit);
+    pump();
+}
+
+void AdaptiveLimiter::setLatencyTolerance(double factor) {
+    tolerance = qMax(1.0, factor);
+}
+
+int AdaptiveLimiter::currentLimit() const {
+    return int(limit);
+}
+
+int AdaptiveLimiter::inFlight() const {
+    return active;
+}
+
+int AdaptiveLimiter::queued() const {
+    return interactive.size() + background.size();
+}
+
+double AdaptiveLimiter::latencyP95() const {
+    if (samples.size() < kMinSamples) {
+        return 0.0;
+    }
+    QVector<double> sorted = samples;
+    const int rank = int(sorted.size() * 0.95);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted.at(rank);
+}
+
+void AdaptiveLimiter::pump() {
+    const qint64 now = clock.elapsed();
+    if (now < pausedUntilMs) {
+        if (!resumeTimer.isActive()) {
+            resumeTimer.start(int(pausedUntilMs - now));
+        }
+        return;
+    }
+
+    for (;;) {
+        Pending pending;
+        if (!interactive.isEmpty() && active < currentLimit()) {
+            pending = interactive.dequeue();
+        } else if (interactive.isEmpty() && !background.isEmpty()
+                   && active < qMax(1, currentLimit() - 1)) {
+            // Фоновые запросы оставляют место для интерактивных
+            pending = background.dequeue();
+        } else {
+            return;
+        }
+
+        const qint64 startedMs = clock.elapsed();
+        QNetworkReply* reply = pending.start();
+        if (!reply) {
+            continue;
+        }
+        ++active;
+        connect(reply, &QNetworkReply::finished, this, [this, reply, startedMs]() {
+            onFinished(reply, startedMs);
+        });
+    }
+}
+
+void AdaptiveLimiter::onFinished(QNetworkReply* reply, qint64 startedMs) {
+    --active;
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QNetworkReply::NetworkError error = reply->error();
+
+    if (status == 429 || status == 503) {
+        const qint64 delay = retryAfterMs(reply);
+        if (delay > 0) {
+            pausedUntilMs = qMax(pausedUntilMs, clock.elapsed() + delay);
+            qDebug() << "[AdaptiveLimiter] Server asked to retry after" << delay << "ms";
+        }
+        decrease();
+    } else if (status >= 500) {
+        decrease();
+    } else if (status == 0 && error != QNetworkReply::NoError
+               && error != QNetworkReply::OperationCanceledError) {
+        // Ответа нет совсем: сервер не успевает или недоступен
+        decrease();
+    } else if (error != QNetworkReply::OperationCanceledError) {
+        recordLatency(double(clock.elapsed() - startedMs));
+    }
+
+    pump();
+}
+
+void AdaptiveLimiter::recordLatency(double ms) {
+    if (samples.size() < kSampleWindow) {
+        samples.append(ms);
+    } else {
+        samples[nextSample] = ms;
+        nextSample = (nextSample + 1) % kSampleWindow;
+    }
+
+    const double p95 = latencyP95();
+    if (p95 <= 0.0) {
+        increase();
+        return;
+    }
+
+    // Базовый уровень - лучший наблюдаемый p95, медленно подтягиваемый к текущему,
+    // чтобы постоянное изменение сети не снижало лимит бесконечно
+    baselineMs = baselineMs < 0.0 ? p95 : qMin(baselineMs, p95);
+    baselineMs += (p95 - baselineMs) * 0.01;
+
+    if (p95 > baselineMs * tolerance) {
+        decrease();
+    } else {
+        increase();
+    }
+}
+
+void AdaptiveLimiter::increase() {
+    // Аддитивный рост: примерно +1 за каждые limit успешных запросов
+    setLimit(limit + 1.0 / limit);
+}
+
+void AdaptiveLimiter::decrease() {
+    const qint64 now = clock.elapsed();
+    if (lastDecreaseMs >= 0 && now - lastDecreaseMs < kDecreaseCooldownMs) {
+        return;
+    }
+    lastDecreaseMs = now;
+    setLimit(limit * kDecreaseFactor);
+}
+
+void AdaptiveLimiter::setLimit(double value) {
+    const int before = currentLimit();
+    limit = qBound(double(minLimit), value, double(maxLimit));
+    if (currentLimit() != before) {
+        emit limitChanged(currentLimit());
+    }
+}
+
+qint64 AdaptiveLimiter::retryAfterMs(QNetworkReply* reply) {
+    const QByteArray value = reply->rawHeader("Retry-After").trimmed();
+    if (value.isEmpty()) {
+        return 0;
+    }
+
+    // Retry-After: число секунд или HTTP-дата
+    bool isNumber = false;
+    const qint64 seconds = value.toLongLong(&isNumber);
+    qint64 delay = 0;
+    if (isNumber) {
+        delay = seconds * 1000;
+    } else {
+        const QDateTime when = QDateTime::fromString(QString::fromLatin1(value), Qt::RFC2822Date);
+        if (when.isValid()) {
+            delay = QDateTime::currentDateTimeUtc().msecsTo(when);
+        }
+    }
+    return qBound<qint64>(0, delay, kMaxRetryAfterMs);
+}
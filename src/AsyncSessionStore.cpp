@@ -0,0 +1,138 @@
+#include "AsyncSessionStore.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QSettings>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QDebug>
+
+AsyncSessionStore::AsyncSessionStore(const QString& path, const QString& legacyGroup, QObject* parent)
+    : SessionStore(parent),
+      m_path(path),
+      m_legacyGroup(legacyGroup),
+      flushTimer(this)
+{
+    worker.setMaxThreadCount(1);
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(500);
+    connect(&flushTimer, &QTimer::timeout, this, &AsyncSessionStore::flush);
+}
+
+AsyncSessionStore::~AsyncSessionStore() {
+    flush();
+    worker.waitForDone();
+}
+
+void AsyncSessionStore::setCoalesceInterval(int ms) {
+    flushTimer.setInterval(qMax(0, ms));
+}
+
+void AsyncSessionStore::load() {
+    const QString path = m_path;
+    const QString legacyGroup = m_legacyGroup;
+
+    worker.start([this, path, legacyGroup]() {
+        bool exists = false;
+        SessionState state = readFile(path, &exists);
+
+        // Перенос токенов, сохраненных прежними версиями в QSettings
+        if (!exists && !legacyGroup.isEmpty()) {
+            QSettings settings;
+            state.accessToken = settings.value(legacyGroup + "/accessToken").toString();
+            state.refreshToken = settings.value(legacyGroup + "/refreshToken").toString();
+            if (state.isActive() && writeFile(path, state)) {
+                settings.remove(legacyGroup);
+            }
+        }
+
+        // Деструктор ждет завершения задачи, поэтому this еще жив
+        QMetaObject::invokeMethod(this, [this, state]() {
+            emit loaded(state);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AsyncSessionStore::save(const SessionState& state) {
+    pending = state;
+    hasPending = true;
+    // Таймер не перезапускаем: при непрерывных обновлениях запись все равно случится
+    if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+}
+
+void AsyncSessionStore::clear() {
+    // Удаление токенов не откладываем
+    pending = SessionState();
+    hasPending = true;
+    flush();
+}
+
+void AsyncSessionStore::flush() {
+    flushTimer.stop();
+    if (!hasPending) {
+        return;
+    }
+    hasPending = false;
+
+    const QString path = m_path;
+    const SessionState state = pending;
+    worker.start([this, path, state]() {
+        if (!state.isActive()) {
+            if (QFile::exists(path) && !QFile::remove(path)) {
+                reportError(QString("Failed to remove session file %1").arg(path));
+            }
+            return;
+        }
+        if (!writeFile(path, state)) {
+            reportError(QString("Failed to write session to %1").arg(path));
+        }
+    });
+}
+
+void AsyncSessionStore::reportError(const QString& message) {
+    qDebug() << "[AsyncSessionStore]" << message;
+    // Вызывается из рабочего потока; деструктор ждет задачи, поэтому this еще жив
+    QMetaObject::invokeMethod(this, [this, message]() {
+        emit error(message);
+    }, Qt::QueuedConnection);
+}
+
+SessionState AsyncSessionStore::readFile(const QString& path, bool* exists) {
+    SessionState state;
+    QFile file(path);
+    *exists = file.exists();
+    if (!file.open(QIODevice::ReadOnly)) {
+        return state;
+    }
+
+    const QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+    state.accessToken = object["accessToken"].toString();
+    state.refreshToken = object["refreshToken"].toString();
+    state.userRole = object["role"].toString();
+    state.userName = object["user"].toString();
+    return state;
+}
+
+bool AsyncSessionStore::writeFile(const QString& path, const SessionState& state) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // QSaveFile пишет во временный файл и переименовывает его при commit()
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    const QJsonObject object{
+        {"accessToken", state.accessToken},
+        {"refreshToken", state.refreshToken},
+        {"role", state.userRole},
+        {"user", state.userName}
+    };
+    file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
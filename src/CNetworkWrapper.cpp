@@ -1,15 +1,41 @@
 #include "CNetworkWrapper.h"
 #include "HandlerFactory.h"
+#include "Endpoints.h"
 #include "AuthHandler.h"
 #include "CoursesHandler.h"
 #include "RegistrationHandler.h"
-#include "ErrorHandler.h"
 #include "TopicHandler.h"
+#include "PageHandler.h"
+#include "TopicGraph.h"
+#include "SearchIndex.h"
+#include "PrefetchEngine.h"
+#include "SessionStore.h"
+#include "AsyncSessionStore.h"
+#include "AdaptiveLimiter.h"
+#include "EndpointSelector.h"
+#include <QElapsedTimer>
+#include <QUrlQuery>
+#include <QStandardPaths>
+#include <memory>
 
 CNetworkWrapper::CNetworkWrapper(QObject *parent)
+    : CNetworkWrapper(nullptr,
+                      new AsyncSessionStore(QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation)
+                                            + "/session.json", "auth"),
+                      parent) {}
+
+CNetworkWrapper::CNetworkWrapper(QNetworkAccessManager* transport, SessionStore* store,
+                                 QObject *parent)
     : QObject(parent),
-      manager(new QNetworkAccessManager(this)),
-      tokenRefreshTimer(this)
+      manager(transport ? transport : new QNetworkAccessManager(this)),
+      graph(new TopicGraph(this)),
+      index(new SearchIndex(this)),
+      limiter(new AdaptiveLimiter(this)),
+      selector(new EndpointSelector(manager, this)),
+      store(store),
+      tokenRefreshTimer(this),
+      streamReconnectTimer(this),
+      streamIdleTimer(this)
 {
     // Настройка SSL
     QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
@@ -24,25 +50,68 @@ CNetworkWrapper::CNetworkWrapper(QObject *parent)
         reply->deleteLater();               // Удаляем reply после обработки
     });*/
     
+    // Удаленные из дерева темы убираем и из поискового индекса
+    connect(graph, &TopicGraph::topicsRemoved, this, [this](const QVector<int>& topicIds) {
+        for (int topicId : topicIds) {
+            index->remove(SearchIndex::EntryKind::Topic, topicId);
+        }
+    });
+    selector->setEndpoints({"http://185.125.100.45:8080"});
+
     initRefreshTimer();
-    loadTokens();
+    streamReconnectTimer.setSingleShot(true);
+    connect(&streamReconnectTimer, &QTimer::timeout, this, &CNetworkWrapper::openChangeStream);
+    // Полуоткрытое TCP-соединение не дает ни данных, ни ошибки - обрываем его сами
+    streamIdleTimer.setSingleShot(true);
+    streamIdleTimer.setInterval(45000);
+    connect(&streamIdleTimer, &QTimer::timeout, this, [this]() {
+        if (!changeStream) {
+            return;
+        }
+        qDebug() << "[CNetworkWrapper] Change stream is silent. Reconnecting";
+        changeStream->abort();
+        if (changesWanted) {
+            scheduleStreamReconnect();
+        }
+    });
     manager->setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
-    
-    // Отложенная проверка сессии после инициализации
-        QTimer::singleShot(0, this, [this]() {
-            if (hasActiveSession()) {
-                qDebug() << "[CNetworkWrapper] Active session found. Refreshing tokens...";
-                refreshAuthToken();
-            } else {
-                qDebug() << "[CNetworkWrapper] Active session not found. Auth required...";
-                emit reauthenticationRequired(); // Сигнал будет обработан
-            }
-        });
+
+    if (store) {
+        store->setParent(this);
+        connect(store, &SessionStore::loaded, this, &CNetworkWrapper::applyLoadedSession);
+        connect(store, &SessionStore::error, this, &CNetworkWrapper::errorOccurred);
+
+        // Индекс сохраняется на диск только для сохраняемых сессий;
+        // файл читается в фоне, конструктор диска не ждет
+        index->setStoragePath(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                              + "/search.idx");
+    }
+
+    // Отложенная проверка сессии после инициализации;
+    // хранилище может загружать токены в фоне, конструктор диска не ждет
+    QTimer::singleShot(0, this, [this]() { loadTokens(); });
+}
+
+void CNetworkWrapper::applyLoadedSession(const SessionState& state) {
+    // Пока шла загрузка, пользователь мог уже войти - новые токены важнее
+    if (session.accessToken.isEmpty() && session.refreshToken.isEmpty()) {
+        session = state;
+        updateBearerHeader();
+    }
+
+    if (hasActiveSession()) {
+        qDebug() << "[CNetworkWrapper] Active session found. Refreshing tokens...";
+        tokenRefreshTimer.start();
+        refreshAuthToken();
+    } else {
+        qDebug() << "[CNetworkWrapper] Active session not found. Auth required...";
+        emit reauthenticationRequired(); // Сигнал будет обработан
+    }
 }
 
 void CNetworkWrapper::initRefreshTimer() {
     connect(&tokenRefreshTimer, &QTimer::timeout, this, [this]() {
-        if (!refreshToken.isEmpty()) {
+        if (!session.refreshToken.isEmpty()) {
             refreshAuthToken();
         }
     });
@@ -50,17 +119,33 @@ void CNetworkWrapper::initRefreshTimer() {
 }
 
 void CNetworkWrapper::restoreSession() {
+    // Обновление токенов запустит applyLoadedSession
     loadTokens();
-    if (!refreshToken.isEmpty()) {
-        refreshAuthToken();
-    }
 }
 
 void CNetworkWrapper::clearSession() {
-    accessToken.clear();
-    refreshToken.clear();
-    QSettings().remove("auth");
+    session.clear();
+    authEndpoint.clear();
+    updateBearerHeader();
+    if (store) {
+        store->clear();
+    }
     tokenRefreshTimer.stop();
+    // Поток уведомлений откроется заново после следующего входа
+    streamReconnectTimer.stop();
+    streamIdleTimer.stop();
+    lastEventId.clear();
+    sseParser.clearLastEventId();
+    if (changeStream) {
+        changeStream->abort();
+    }
+    // Данные другого пользователя могут отличаться
+    cancelPrefetches();
+    if (prefetcher) {
+        prefetcher->clear();
+    }
+    graph->clear();
+    index->clear();
 }
 
 void CNetworkWrapper::authenticate(const QString& email, const QString& password) {
@@ -68,7 +153,8 @@ void CNetworkWrapper::authenticate(const QString& email, const QString& password
         {"email", email},
         {"password", password}
     };
-    sendPostRequest("/api/auth/login/", data);
+    // Учетная запись нужна сессии, но в ответе сервера ее нет
+    sendPostRequest<Api::Login>(data, QVariantMap{{"user", email}});
 }
 
 void CNetworkWrapper::registerUser(const QString& email, const QString& password) {
@@ -76,25 +162,26 @@ void CNetworkWrapper::registerUser(const QString& email, const QString& password
         {"email", email},
         {"password", password}
     };
-    sendPostRequest("/api/auth/register/", data);
+    sendPostRequest<Api::Register>(data);
 }
 
 void CNetworkWrapper::fetchCourses() {
-    if (accessToken.isEmpty()) {
+    if (session.accessToken.isEmpty()) {
         emit errorOccurred("Not authenticated");
         return;
     }
 
-    QUrl url(baseUrl + "/api/courses/courses");
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", "Bearer " + accessToken.toUtf8());
-    
-    qDebug() << "[fetchCourses] Request URL:" << url.toString();
-    
-    QNetworkReply* reply = manager->get(request); // Сохраняем reply
+    cancelPrefetches();
 
+    dispatchRequest([this](const QString& baseUrl) {
+        QNetworkRequest request = Api::request<Api::Courses>(baseUrl, bearerHeader);
+        
+        qDebug() << "[fetchCourses] Request URL:" << request.url().toString();
+        
+        return manager->get(request);
+    },
     // Подключаем обработчик завершения запроса
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+    [this](QNetworkReply* reply) {
         QByteArray response = reply->readAll();
         const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
         
@@ -102,7 +189,10 @@ void CNetworkWrapper::fetchCourses() {
         qDebug() << "Courses response data:" << response;
 
         if (reply->error() == QNetworkReply::NoError) {
-            handleNetworkReply(reply, response);
+            QJsonDocument doc;
+            if (handleNetworkReply(reply, response, doc)) {
+                decodeReply<Api::Courses>(reply, doc);
+            }
         } else {
             handleNetworkError(reply, status, response);
         }
@@ -112,86 +202,342 @@ void CNetworkWrapper::fetchCourses() {
 }
 
 void CNetworkWrapper::fetchTopics(int courseId, int parentTopicId) {
-    if (accessToken.isEmpty()) {
+    if (session.accessToken.isEmpty()) {
         emit errorOccurred("Not authenticated");
         return;
     }
 
-    // Формируем URL по структуре из curl-примера
-    QString endpoint = parentTopicId == -1
-        ? QString("/api/courses/%1/themes/").arg(courseId)
-        : QString("/api/courses/%1/themes/%2/").arg(courseId).arg(parentTopicId);
+    if (parentTopicId == -1 && prefetcher) {
+        QJsonArray cached;
+        if (prefetcher->takePrefetched(courseId, cached)) {
+            // Отдаем асинхронно, как и ответ из сети
+            QTimer::singleShot(0, this, [this, cached]() {
+                emit subtopicsFetched(-1, cached);
+            });
+            return;
+        }
+    }
+    cancelPrefetches();
 
-    QUrl url(baseUrl + endpoint);
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", "Bearer " + accessToken.toUtf8());
-    
-    // Сохраняем контекст (parentTopicId) в свойстве reply
-    QNetworkReply* reply = manager->get(request);
-    reply->setProperty("parentTopicId", parentTopicId);
-    
+    dispatchRequest([this, courseId, parentTopicId](const QString& baseUrl) {
+        // Формируем URL по структуре из curl-примера
+        QNetworkRequest request = parentTopicId == -1
+            ? Api::request<Api::CourseTopics>(baseUrl, bearerHeader, courseId)
+            : Api::request<Api::Subtopics>(baseUrl, bearerHeader, courseId, parentTopicId);
+        
+        // Сохраняем контекст (parentTopicId) в свойстве reply
+        QNetworkReply* reply = manager->get(request);
+        reply->setProperty("courseId", courseId);
+        reply->setProperty("parentTopicId", parentTopicId);
+        return reply;
+    },
     // Обработка через общий handleNetworkReply
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+    [this, parentTopicId](QNetworkReply* reply) {
         QByteArray data = reply->readAll();
-        handleNetworkReply(reply, data);
+        QJsonDocument doc;
+        if (handleNetworkReply(reply, data, doc)) {
+            if (parentTopicId == -1) {
+                decodeReply<Api::CourseTopics>(reply, doc);
+            } else {
+                decodeReply<Api::Subtopics>(reply, doc);
+            }
+        }
         reply->deleteLater();
     });
 }
+quint64 CNetworkWrapper::fetchCoursesPage(int offset, int limit) {
+    if (session.accessToken.isEmpty()) {
+        emit errorOccurred("Not authenticated");
+        return 0;
+    }
+
+    cancelPrefetches();
+    return sendPageRequest<Api::Courses>(offset, limit);
+}
+
+quint64 CNetworkWrapper::fetchTopicsPage(int courseId, int parentTopicId, int offset, int limit) {
+    if (session.accessToken.isEmpty()) {
+        emit errorOccurred("Not authenticated");
+        return 0;
+    }
+
+    cancelPrefetches();
+    if (parentTopicId == -1) {
+        return sendPageRequest<Api::CourseTopics>(offset, limit, courseId);
+    }
+    return sendPageRequest<Api::Subtopics>(offset, limit, courseId, parentTopicId);
+}
+
+template <typename E, typename... Ids>
+quint64 CNetworkWrapper::sendPageRequest(int offset, int limit, Ids... ids) {
+    static_assert(E::method == Api::Method::Get, "sendPageRequest needs a GET endpoint");
+    // По номеру подписчик отличает ответ на свой запрос от устаревших
+    const quint64 requestId = ++lastPageRequest;
+
+    dispatchRequest([this, offset, limit, ids...](const QString& baseUrl) {
+        QNetworkRequest request = Api::request<E>(baseUrl, bearerHeader, ids...);
+        QUrl url = request.url();
+        QUrlQuery query;
+        query.addQueryItem("limit", QString::number(limit));
+        query.addQueryItem("offset", QString::number(offset));
+        url.setQuery(query);
+        request.setUrl(url);
+        return manager->get(request);
+    },
+    // Контекст страницы известен здесь, а не из свойств ответа
+    [this, requestId, offset, limit, ids...](QNetworkReply* reply) {
+        QByteArray data = reply->readAll();
+        QJsonDocument doc;
+        const bool delivered = handleNetworkReply(reply, data, doc)
+                            && decodePage<E>(doc, requestId, offset, limit, ids...);
+
+        // Страница не пришла: список должен узнать об этом, чтобы запросить ее снова
+        if (!delivered) {
+            reportPageFailed(E{}, requestId, offset, ids...);
+        }
+        reply->deleteLater();
+    }, false, std::function<void()>(), Route::Fastest, E::idempotent);
+    return requestId;
+}
+
+void CNetworkWrapper::dispatchRequest(std::function<QNetworkReply*(const QString&)> send,
+                                      std::function<void(QNetworkReply*)> onFinished,
+                                      bool lowPriority, std::function<void()> onDropped,
+                                      Route route, bool idempotent, int attempt) {
+    // Запрос уходит в сеть, только когда ограничитель выделит ему место
+    limiter->submit([=]() {
+        // Повторы идут на лучший из оставшихся: отказавший сервер уже помечен
+        const QString endpoint = route == Route::Sticky && attempt == 0
+            ? selector->selectPreferring(authEndpoint)
+            : selector->select();
+        QElapsedTimer elapsed;
+        elapsed.start();
+
+        QNetworkReply* reply = send(endpoint);
+        connect(reply, &QNetworkReply::finished, this, [=]() {
+            const QNetworkReply::NetworkError error = reply->error();
+            if (!isConnectionError(error)) {
+                selector->reportSuccess(endpoint, double(elapsed.elapsed()));
+                if (route == Route::Sticky && error == QNetworkReply::NoError) {
+                    authEndpoint = endpoint;
+                }
+                onFinished(reply);
+                return;
+            }
+
+            selector->reportFailure(endpoint);
+            // Неидемпотентный запрос повторяем, только если он точно не дошел до сервера
+            const bool safeToRetry = idempotent
+                || error == QNetworkReply::ConnectionRefusedError
+                || error == QNetworkReply::HostNotFoundError;
+            if (safeToRetry && attempt + 1 < selector->count()) {
+                qDebug() << "[CNetworkWrapper]" << endpoint << "failed:" << reply->errorString()
+                         << "- retrying on another endpoint";
+                reply->deleteLater();
+                dispatchRequest(send, onFinished, lowPriority, onDropped, route, idempotent, attempt + 1);
+                return;
+            }
+            onFinished(reply);
+        });
+        return reply;
+    }, lowPriority, onDropped);
+}
+
+bool CNetworkWrapper::isConnectionError(QNetworkReply::NetworkError error) {
+    switch (error) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::HostNotFoundError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+template <typename E, typename... Ids>
+bool CNetworkWrapper::decodePage(const QJsonDocument& doc, quint64 requestId, int offset, int limit,
+                                 Ids... ids) {
+    const QJsonObject response = Api::responseObject<E>(doc);
+    if (handleErrorResponse(response)) {
+        return false;
+    }
+
+    PageHandler handler(offset, limit);
+    connect(&handler, &ResponseHandler::error,
+            this, &CNetworkWrapper::errorOccurred);
+
+    bool delivered = false;
+    connect(&handler, &PageHandler::pageReceived,
+            this, [this, &delivered, requestId, ids...](int offset, const QJsonArray& items, int total) {
+                delivered = true;
+                deliverPage(E{}, requestId, offset, items, total, ids...);
+            });
+    handler.process(response);
+    return delivered;
+}
+
+void CNetworkWrapper::deliverPage(Api::Courses, quint64 requestId, int offset,
+                                  const QJsonArray& items, int totalCount) {
+    index->indexCourses(items);
+    emit coursesPageReceived(offset, items, totalCount, requestId);
+}
+
+void CNetworkWrapper::deliverPage(Api::CourseTopics, quint64 requestId, int offset,
+                                  const QJsonArray& items, int totalCount, int courseId) {
+    deliverPage(Api::Subtopics{}, requestId, offset, items, totalCount, courseId, -1);
+}
+
+void CNetworkWrapper::deliverPage(Api::Subtopics, quint64 requestId, int offset,
+                                  const QJsonArray& items, int totalCount,
+                                  int courseId, int parentTopicId) {
+    graph->applySubtopics(courseId, parentTopicId, items, false);
+    index->indexTopics(items);
+    emit subtopicsPageReceived(courseId, parentTopicId, offset, items, totalCount, requestId);
+}
+
+void CNetworkWrapper::reportPageFailed(Api::Courses, quint64 requestId, int offset) {
+    emit coursesPageFailed(offset, requestId);
+}
+
+void CNetworkWrapper::reportPageFailed(Api::CourseTopics, quint64 requestId, int offset, int courseId) {
+    emit subtopicsPageFailed(courseId, -1, offset, requestId);
+}
+
+void CNetworkWrapper::reportPageFailed(Api::Subtopics, quint64 requestId, int offset,
+                                       int courseId, int parentTopicId) {
+    emit subtopicsPageFailed(courseId, parentTopicId, offset, requestId);
+}
+
 void CNetworkWrapper::refreshAuthToken() {
-    if (refreshToken.isEmpty()) {
+    if (session.refreshToken.isEmpty()) {
         emit reauthenticationRequired();
         return;
     }
 
-    QJsonObject data{{"refresh", refreshToken}};
-    sendPostRequest("/api/auth/refresh/", data);
+    QJsonObject data{{"refresh", session.refreshToken}};
+    sendPostRequest<Api::Refresh>(data);
 }
 
 void CNetworkWrapper::saveTokens() {
-    QSettings settings;
-    settings.setValue("auth/accessToken", accessToken);
-    settings.setValue("auth/refreshToken", refreshToken);
+    if (store) {
+        store->save(session); // Без хранилища сессия живет только в памяти
+    }
 }
 
 void CNetworkWrapper::loadTokens() {
-    QSettings settings;
-    accessToken = settings.value("auth/accessToken").toString();
-    refreshToken = settings.value("auth/refreshToken").toString();
-    
-    if (!accessToken.isEmpty() && !refreshToken.isEmpty()) {
-        tokenRefreshTimer.start();
+    if (store) {
+        store->load();
+    } else {
+        applyLoadedSession(SessionState());
     }
 }
 
-void CNetworkWrapper::sendPostRequest(const QString& endpoint, const QJsonObject& data) {
-    // 1. Формируем полный URL
-    QUrl fullUrl(baseUrl + endpoint);
-    
-    qDebug() << "Request URL:" << fullUrl.toString();
-    QNetworkRequest request(fullUrl);
+void CNetworkWrapper::setPrefetchEngine(PrefetchEngine* engine) {
+    cancelPrefetches();
+    prefetcher = engine;
+}
 
-       // 2. Устанавливаем заголовки
-       request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("User-Agent", "YourApp/1.0");
+void CNetworkWrapper::prefetchTopics(int courseId) {
+    if (session.accessToken.isEmpty()) {
+        if (prefetcher) {
+            prefetcher->prefetchFailed(courseId, false);
+        }
+        return;
+    }
 
-    qDebug() << "Request headers:" << request.rawHeaderList();
+    dispatchRequest([this, courseId](const QString& baseUrl) {
+        QNetworkRequest request = Api::request<Api::CourseTopics>(baseUrl, bearerHeader, courseId);
+        // Упреждающие запросы не должны мешать интерактивным
+        request.setPriority(QNetworkRequest::LowPriority);
+
+        QNetworkReply* reply = manager->get(request);
+        prefetchReplies.append(reply);
+        return reply;
+    },
+    // Ответ не проходит через handleNetworkReply: подписчики subtopicsFetched
+    // получат темы только когда пользователь действительно откроет курс
+    [this, courseId](QNetworkReply* reply) {
+        prefetchReplies.removeAll(reply);
+        reply->deleteLater();
+        const QByteArray data = reply->readAll();
+        if (!prefetcher) {
+            return;
+        }
+        if (reply->error() != QNetworkReply::NoError) {
+            prefetcher->prefetchFailed(courseId, reply->error() == QNetworkReply::OperationCanceledError);
+            return;
+        }
+
+        const QJsonDocument doc = QJsonDocument::fromJson(data);
+        QJsonArray subtopics;
+        if (doc.isArray()) {
+            subtopics = doc.array();
+        } else if (doc.object()["subtopics"].isArray()) {
+            subtopics = doc.object()["subtopics"].toArray();
+        } else {
+            prefetcher->prefetchFailed(courseId, false);
+            return;
+        }
 
-       // 3. Сериализуем JSON
+        graph->applySubtopics(courseId, -1, subtopics);
+        index->indexTopics(subtopics);
+        prefetcher->storePrefetched(courseId, subtopics, data.size());
+    },
+    true,
+    // Запрос отменили, пока он ждал в очереди
+    [this, courseId]() {
+        if (prefetcher) {
+            prefetcher->prefetchFailed(courseId, true);
+        }
+    });
+}
+
+void CNetworkWrapper::cancelPrefetches() {
+    // Сначала очередь: иначе отмена активных запросов освободит место ожидающим
+    limiter->dropLowPriority();
+
+    const QList<QPointer<QNetworkReply>> replies = prefetchReplies;
+    prefetchReplies.clear();
+    for (const QPointer<QNetworkReply>& reply : replies) {
+        if (reply) {
+            reply->abort();
+        }
+    }
+}
+
+template <typename E>
+void CNetworkWrapper::sendPostRequest(const QJsonObject& data, const QVariantMap& context) {
+    static_assert(E::method == Api::Method::Post, "sendPostRequest needs a POST endpoint");
+    cancelPrefetches();
+
+       // 1. Сериализуем JSON
        QByteArray jsonData = QJsonDocument(data).toJson(QJsonDocument::Compact).trimmed();
     qDebug() << "Sending RAW JSON:" << jsonData.constData();
 
-       // 4. Отправляем запрос и получаем ответ
-       QNetworkReply* reply = manager->post(request, jsonData);
+    dispatchRequest([this, jsonData, context](const QString& baseUrl) {
+        // 2. Формируем запрос по описанию конечной точки
+        QNetworkRequest request = Api::request<E>(baseUrl, bearerHeader);
+        
+        qDebug() << "Request URL:" << request.url().toString();
+
+        // 3. Дополнительные заголовки
+        request.setRawHeader("User-Agent", "YourApp/1.0");
 
-    /*/ 5. Чтение данных по мере поступления
-        connect(reply, &QNetworkReply::readyRead, this, [reply]() {
-            
-            
-            qDebug() << "Response data chunk:" << QString::fromUtf8(reply->readAll());
-        });
+        qDebug() << "Request headers:" << request.rawHeaderList();
 
-    */// 5. Обработка завершения
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        // 4. Отправляем запрос и получаем ответ
+        QNetworkReply* reply = manager->post(request, jsonData);
+        for (auto it = context.cbegin(); it != context.cend(); ++it) {
+            reply->setProperty(it.key().toUtf8().constData(), it.value());
+        }
+        return reply;
+    },
+    // 5. Обработка завершения
+    [this](QNetworkReply* reply) {
         QByteArray response = reply->readAll();
       //  qDebug() << "Full response:" << response;
 
@@ -199,15 +545,21 @@ void CNetworkWrapper::sendPostRequest(const QString& endpoint, const QJsonObject
             //qDebug() << "Error:" << reply->errorString();
             handleNetworkError(reply, reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), response);
         } else {
-            handleNetworkReply(reply, response);
+            QJsonDocument doc;
+            if (handleNetworkReply(reply, response, doc)) {
+                decodeReply<E>(reply, doc);
+            }
         }
 
         reply->deleteLater();
-    });
+    },
+    // Запросы аутентификации идут на сервер, выдавший токены
+    false, std::function<void()>(), Route::Sticky, E::idempotent);
 }
    
 
-void CNetworkWrapper::handleNetworkReply(QNetworkReply* reply, const QByteArray& data) {
+bool CNetworkWrapper::handleNetworkReply(QNetworkReply* reply, const QByteArray& data,
+                                         QJsonDocument& doc) {
     const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     QByteArray cleanedData = data.trimmed().replace("\\n", "");
     
@@ -220,111 +572,366 @@ void CNetworkWrapper::handleNetworkReply(QNetworkReply* reply, const QByteArray&
             if (status == 204) { // 204 No Content - нормальное поведение
                 qDebug() << "Empty response (HTTP 204) - ignoring";
                 reply->deleteLater();
-                return;
+                return false;
             }
             qDebug() << "Empty response with status" << status << "- ignoring";
             reply->deleteLater();
-            return; // Просто выходим, не эмитируя ошибку
+            return false; // Просто выходим, не эмитируя ошибку
         }
     
     if (data.isEmpty()) {
             emit errorOccurred("Empty response from server");
             reply->deleteLater();
-            return;
+            return false;
         }
     
     if (reply->error() != QNetworkReply::NoError) {
         handleNetworkError(reply, status, data);
         reply->deleteLater();
-        return;
+        return false;
     }
     // Декодируем HTML-сущности
     //cleanedData = QTextCodec::codecForName("UTF-8")->toUnicode(cleanedData).toUtf8();
         
     // Проверяем валидность JSON
     QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(cleanedData, &parseError);
+    doc = QJsonDocument::fromJson(cleanedData, &parseError);
     if (parseError.error != QJsonParseError::NoError) {
         emit errorOccurred("Invalid JSON response");
         reply->deleteLater();
-        return;
+        return false;
     }
-    // Если данные начинаются с '[', парсим как массив
-        if (cleanedData.startsWith('[')) {
-            doc = QJsonDocument::fromJson(cleanedData, &parseError);
-            QJsonObject wrapper;
-            wrapper["courses"] = doc.array(); // Оборачиваем массив в объект
-            doc = QJsonDocument(wrapper);
-        } else {
-            doc = QJsonDocument::fromJson(cleanedData, &parseError);
-        }
+    // Голые массивы оборачивает разборщик конечной точки: он знает, что в них
+    return true;
+}
 
-    
-    // Создаем обработчик через фабрику
-    ResponseHandler* handler = HandlerFactory::createHandler(doc.object());
-    if (!handler) {
-        qDebug() << "Empty or unrecognized response - ignoring";
-        reply->deleteLater();
-        return; // Не эмитируем ошибку
-    }
+template <typename E>
+void CNetworkWrapper::decodeReply(QNetworkReply* reply, const QJsonDocument& doc) {
+    static_assert(!std::is_void_v<typename E::Decoder>, "Endpoint has no response handler");
 
-    // Подключаем обработчики сигналов
-    connect(handler, &ResponseHandler::error,
-            this, &CNetworkWrapper::errorOccurred);
+    const QJsonObject response = Api::responseObject<E>(doc);
 
-    if (auto authHandler = qobject_cast<AuthHandler*>(handler)) {
-        connect(authHandler, &AuthHandler::authSuccess,
-                this, [this](const QString& access, const QString& refresh, const QString& role) {
-                    accessToken = access;
-                    refreshToken = refresh;
-                    userRole = role; // Используем роль из ответа
-                    saveTokens();
-                    tokenRefreshTimer.start();
-                    emit authSuccess(access, refresh, role); // Обновляем сигнал
-                });
-    }
-    else if (auto coursesHandler = qobject_cast<CoursesHandler*>(handler)) {
-        connect(coursesHandler, &CoursesHandler::coursesDataReceived,
-                this, &CNetworkWrapper::coursesReceived);
-    }
-    else if (auto topicHandler = qobject_cast<TopicHandler*>(handler)) {
-        int parentTopicId = reply->property("parentTopicId").toInt();
-        
-        connect(topicHandler, &TopicHandler::subtopicsReceived,
-                this, [this, parentTopicId](int topicId, const QJsonArray& subtopics) {
-                    emit subtopicsFetched(parentTopicId, subtopics);
-                });
-        
-        connect(topicHandler, &TopicHandler::materialsReceived,
-                this, &CNetworkWrapper::materialsFetched);
+    // Пустой JSON (например: {}) - не ошибка
+    if (response.isEmpty()) {
+        qDebug() << "Empty response - ignoring";
+        return;
     }
-    else if (auto regHandler = qobject_cast<RegistrationHandler*>(handler)) {
-        connect(regHandler, &RegistrationHandler::registrationSuccess,
-                this, [this]() {
-                    // После регистрации автоматически аутентифицируемся
-                    authenticate("user@example.com", "securePassword123");
-                });
-        connect(regHandler, &RegistrationHandler::error,
-                this, &CNetworkWrapper::errorOccurred);
+    if (handleErrorResponse(response)) {
+        return;
     }
 
-    else if (auto errorHandler = qobject_cast<ErrorHandler*>(handler)) {
-        connect(errorHandler, &ErrorHandler::error,
-                this, &CNetworkWrapper::errorOccurred);
+    typename E::Decoder handler;
+    connect(&handler, &ResponseHandler::error,
+            this, &CNetworkWrapper::errorOccurred);
+    bindHandler(handler, reply);
+    handler.process(response);
+}
+
+bool CNetworkWrapper::handleErrorResponse(const QJsonObject& response) {
+    std::unique_ptr<ResponseHandler> errorHandler(HandlerFactory::createErrorHandler(response));
+    if (!errorHandler) {
+        return false;
     }
+    connect(errorHandler.get(), &ResponseHandler::error,
+            this, &CNetworkWrapper::errorOccurred);
+    errorHandler->process(response);
+    return true;
+}
 
-    // Запускаем обработку
-    handler->process(doc.object());
-    handler->deleteLater();
-    reply->deleteLater();
+void CNetworkWrapper::bindHandler(AuthHandler& handler, QNetworkReply* reply) {
+    // Только вход знает учетную запись; обновление токенов ее сохраняет
+    const QString user = reply->property("user").toString();
+
+    connect(&handler, &AuthHandler::authSuccess,
+            this, [this, user](const QString& access, const QString& refresh, const QString& role) {
+                session.accessToken = access;
+                session.refreshToken = refresh;
+                session.userRole = role; // Используем роль из ответа
+                if (!user.isEmpty()) {
+                    session.userName = user;
+                }
+                updateBearerHeader();
+                saveTokens();
+                tokenRefreshTimer.start();
+                // Поток уведомлений ждал входа или нового токена
+                if (changesWanted && !changeStream) {
+                    streamReconnectTimer.stop();
+                    openChangeStream();
+                }
+                emit authSuccess(access, refresh, role); // Обновляем сигнал
+            });
+}
+
+void CNetworkWrapper::bindHandler(CoursesHandler& handler, QNetworkReply*) {
+    connect(&handler, &CoursesHandler::coursesDataReceived,
+            this, [this](const QJsonArray& courses) {
+                index->indexCourses(courses);
+                emit coursesReceived(courses);
+            });
+}
+
+void CNetworkWrapper::bindHandler(TopicHandler& handler, QNetworkReply* reply) {
+    int courseId = reply->property("courseId").toInt();
+    int parentTopicId = reply->property("parentTopicId").toInt();
+
+    connect(&handler, &TopicHandler::subtopicsReceived,
+            this, [this, courseId, parentTopicId](int topicId, const QJsonArray& subtopics) {
+                graph->applySubtopics(courseId, parentTopicId, subtopics);
+                index->indexTopics(subtopics);
+                emit subtopicsFetched(parentTopicId, subtopics);
+            });
+
+    connect(&handler, &TopicHandler::materialsReceived,
+            this, [this, parentTopicId](int topicId, const QJsonArray& materials) {
+                // Материалы относятся к запрошенной теме
+                graph->applyMaterials(parentTopicId != -1 ? parentTopicId : topicId, materials);
+                index->indexMaterials(materials);
+                emit materialsFetched(topicId, materials);
+            });
+}
+
+void CNetworkWrapper::bindHandler(RegistrationHandler& handler, QNetworkReply*) {
+    connect(&handler, &RegistrationHandler::registrationSuccess,
+            this, [this]() {
+                // После регистрации автоматически аутентифицируемся
+                authenticate("user@example.com", "securePassword123");
+            });
+}
+
+void CNetworkWrapper::updateBearerHeader() {
+    // Собираем один раз на токен, а не на каждый запрос
+    bearerHeader.clear();
+    if (!session.accessToken.isEmpty()) {
+        bearerHeader = "Bearer " + session.accessToken.toUtf8();
+    }
 }
 
 bool CNetworkWrapper::hasActiveSession() const {
-    return !accessToken.isEmpty() && !refreshToken.isEmpty();
+    return session.isActive();
+}
+
+void CNetworkWrapper::setBaseUrl(const QString& url) {
+    selector->setEndpoints({url});
+}
+
+void CNetworkWrapper::setEndpoints(const QStringList& urls) {
+    selector->setEndpoints(urls);
+}
+
+EndpointSelector* CNetworkWrapper::endpointSelector() const {
+    return selector;
+}
+
+void CNetworkWrapper::setEndpointSelector(EndpointSelector* shared) {
+    if (!shared || shared == selector) {
+        return;
+    }
+    if (selector->parent() == this) {
+        delete selector;
+    }
+    selector = shared;
 }
 
 QString CNetworkWrapper::getUserRole() const {
-    return userRole;
+    return session.userRole;
+}
+
+QString CNetworkWrapper::currentUser() const {
+    return session.userName;
+}
+
+TopicGraph* CNetworkWrapper::topicGraph() const {
+    return graph;
+}
+
+SearchIndex* CNetworkWrapper::searchIndex() const {
+    return index;
+}
+
+void CNetworkWrapper::subscribeChanges() {
+    changesWanted = true;
+    if (!changeStream && !streamReconnectTimer.isActive()) {
+        openChangeStream();
+    }
+}
+
+void CNetworkWrapper::unsubscribeChanges() {
+    changesWanted = false;
+    streamReconnectTimer.stop();
+    streamIdleTimer.stop();
+    if (changeStream) {
+        changeStream->abort();
+    }
+}
+
+bool CNetworkWrapper::isSubscribedToChanges() const {
+    return changesWanted;
+}
+
+void CNetworkWrapper::setChangeStreamIdleTimeout(int ms) {
+    streamIdleTimer.setInterval(qMax(1000, ms));
+}
+
+void CNetworkWrapper::openChangeStream() {
+    if (!changesWanted || changeStream) {
+        return;
+    }
+    if (session.accessToken.isEmpty()) {
+        return; // Поток откроется после входа
+    }
+
+    // Поток держит соединение постоянно, поэтому идет мимо ограничителя
+    const QString endpoint = selector->select();
+    QNetworkRequest request = Api::request<Api::ChangeEvents>(endpoint, bearerHeader);
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setRawHeader("Cache-Control", "no-cache");
+    if (!lastEventId.isEmpty()) {
+        // Сервер дошлет пропущенные за время разрыва события
+        request.setRawHeader("Last-Event-ID", lastEventId.toUtf8());
+    }
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    request.setTransferTimeout(0);
+
+    sseParser.reset();
+    QNetworkReply* reply = manager->get(request);
+    changeStream = reply;
+    streamIdleTimer.start();
+
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+        // Любые данные, включая комментарии-пульсы, подтверждают, что соединение живо
+        streamIdleTimer.start();
+        // Тело ответа с ошибкой не является потоком событий
+        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+            return;
+        }
+        if (!reply->property("streamOpen").toBool()) {
+            reply->setProperty("streamOpen", true);
+            streamAttempts = 0;
+            qDebug() << "[CNetworkWrapper] Change stream connected";
+            emit changeStreamStateChanged(true);
+        }
+        for (const SseEvent& event : sseParser.feed(reply->readAll())) {
+            handleChangeEvent(event);
+        }
+    });
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, endpoint]() {
+        reply->deleteLater();
+        if (changeStream == reply) {
+            changeStream.clear();
+            streamIdleTimer.stop();
+        }
+        if (reply->property("streamOpen").toBool()) {
+            emit changeStreamStateChanged(false);
+        }
+        // Поток закрыли сами
+        if (!changesWanted || reply->error() == QNetworkReply::OperationCanceledError) {
+            return;
+        }
+
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (isConnectionError(reply->error())) {
+            selector->reportFailure(endpoint);
+        }
+        if (status == 204) {
+            // По протоколу SSE 204 означает "не переподключаться"
+            qDebug() << "[CNetworkWrapper] Server closed the change stream";
+            changesWanted = false;
+            return;
+        }
+        if (status == 403 || status == 404) {
+            // Повторы не помогут: потока нет или он запрещен этому пользователю
+            changesWanted = false;
+            emit errorOccurred(QString("Change stream unavailable (%1)").arg(status));
+            return;
+        }
+        if (status == 401) {
+            // Поток переоткроется в обработчике authSuccess
+            refreshAuthToken();
+            return;
+        }
+        scheduleStreamReconnect();
+    });
+}
+
+void CNetworkWrapper::scheduleStreamReconnect() {
+    // Поле retry задает начальную задержку; при повторных неудачах она
+    // растет так же, как собственная, чтобы не долбить упавший сервер
+    const int serverRetryMs = sseParser.retryInterval();
+    const int baseMs = serverRetryMs >= 0 ? serverRetryMs : 1000;
+    const qint64 capMs = qMax(30000, baseMs);
+    // retry: 0 разрешает мгновенный повтор только один раз
+    const qint64 growMs = qMax(baseMs, 1000);
+    const int delay = streamAttempts == 0
+        ? baseMs
+        : int(qMin<qint64>(growMs << qMin(streamAttempts, 16), capMs));
+    ++streamAttempts;
+
+    qDebug() << "[CNetworkWrapper] Change stream lost. Reconnecting in" << delay << "ms";
+    streamReconnectTimer.start(delay);
+}
+
+void CNetworkWrapper::handleChangeEvent(const SseEvent& event) {
+    if (!event.id.isEmpty()) {
+        lastEventId = event.id;
+    }
+
+    const QJsonObject payload = QJsonDocument::fromJson(event.data.toUtf8()).object();
+
+    if (event.type == "course_created" || event.type == "course_updated") {
+        const QJsonObject course = payload["course"].isObject() ? payload["course"].toObject() : payload;
+        index->indexCourses(QJsonArray{course});
+        emit courseChanged(course, event.type == "course_created");
+    }
+    else if (event.type == "course_deleted") {
+        const int courseId = payload["id"].toInt();
+        for (int topicId : graph->rootTopics(courseId)) {
+            graph->removeTopic(topicId);
+        }
+        index->remove(SearchIndex::EntryKind::Course, courseId);
+        if (prefetcher) {
+            prefetcher->invalidate(courseId);
+        }
+        emit courseRemoved(courseId);
+    }
+    else if (event.type == "topic_created" || event.type == "topic_updated") {
+        const int courseId = payload["course_id"].toInt();
+        const int parentTopicId = payload["parent_id"].isDouble() ? payload["parent_id"].toInt() : -1;
+        const QJsonObject topic = payload["topic"].toObject();
+        // Патчим только эту тему, соседние остаются как есть
+        graph->applySubtopics(courseId, parentTopicId, QJsonArray{topic}, false);
+        index->indexTopics(QJsonArray{topic});
+        if (prefetcher && parentTopicId == -1) {
+            prefetcher->invalidate(courseId);
+        }
+        emit topicChanged(courseId, parentTopicId, topic, event.type == "topic_created");
+    }
+    else if (event.type == "topic_deleted") {
+        const int courseId = payload["course_id"].toInt();
+        const int topicId = payload["id"].toInt();
+        const TopicNode* node = graph->node(topicId);
+        // У заглушки parentId == -1, но корнем курса она не является
+        if (prefetcher && (!node || (node->parentId == -1 && !node->placeholder))) {
+            prefetcher->invalidate(courseId);
+        }
+        graph->removeTopic(topicId);
+        index->remove(SearchIndex::EntryKind::Topic, topicId);
+        emit topicRemoved(courseId, topicId);
+    }
+    else if (event.type == "materials_updated") {
+        const int topicId = payload["topic_id"].toInt();
+        const QJsonArray materials = payload["materials"].toArray();
+        graph->applyMaterials(topicId, materials);
+        index->indexMaterials(materials);
+        emit materialsFetched(topicId, materials);
+    }
+    else {
+        qDebug() << "[CNetworkWrapper] Ignoring change event" << event.type;
+    }
+}
+
+AdaptiveLimiter* CNetworkWrapper::concurrencyLimiter() const {
+    return limiter;
 }
 
 
@@ -349,7 +956,7 @@ void CNetworkWrapper::handleNetworkError(QNetworkReply* reply, int status, const
 
     // Обработка 401 (Unauthorized)
     if (status == 401) {
-        if (!refreshToken.isEmpty()) {
+        if (!session.refreshToken.isEmpty()) {
             // Проверка на "Token is blacklisted"
             if (response.contains("detail") && response["detail"].toString().contains("blacklisted")) {
                 qDebug() << "[CNetworkWrapper] Refresh token is blacklisted. Session cleared.";
@@ -0,0 +1,160 @@
+#include "EndpointSelector.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QDebug>
+
+namespace {
+const double kEwmaAlpha = 0.3;
+const int kHealthCheckTimeoutMs = 3000;
+}
+
+EndpointSelector::EndpointSelector(QNetworkAccessManager* manager, QObject* parent)
+    : QObject(parent),
+      manager(manager),
+      healthTimer(this)
+{
+    clock.start();
+    healthTimer.setInterval(10000);
+    connect(&healthTimer, &QTimer::timeout, this, &EndpointSelector::runHealthChecks);
+}
+
+void EndpointSelector::setEndpoints(const QStringList& urls) {
+    QVector<Endpoint> updated;
+    for (const QString& url : urls) {
+        // Сохраняем накопленную статистику уже известных серверов
+        const Endpoint* known = find(url);
+        updated.append(known ? *known : Endpoint{url});
+    }
+    items = updated;
+
+    // С одним сервером выбирать не из чего
+    if (items.size() > 1) {
+        healthTimer.start();
+        runHealthChecks();
+    } else {
+        healthTimer.stop();
+    }
+}
+
+QStringList EndpointSelector::endpoints() const {
+    QStringList urls;
+    for (const Endpoint& endpoint : items) {
+        urls.append(endpoint.url);
+    }
+    return urls;
+}
+
+int EndpointSelector::count() const {
+    return items.size();
+}
+
+QString EndpointSelector::select() const {
+    const Endpoint* best = nullptr;
+    for (const Endpoint& endpoint : items) {
+        if (!endpoint.healthy) {
+            continue;
+        }
+        // Неизмеренный сервер считаем быстрым, чтобы он получил шанс
+        const double latency = qMax(0.0, endpoint.ewmaMs);
+        if (!best || latency < qMax(0.0, best->ewmaMs)) {
+            best = &endpoint;
+        }
+    }
+    if (best) {
+        return best->url;
+    }
+
+    // Доступных нет: пробуем тот, что отказал раньше всех
+    for (const Endpoint& endpoint : items) {
+        if (!best || endpoint.lastFailureMs < best->lastFailureMs) {
+            best = &endpoint;
+        }
+    }
+    return best ? best->url : QString();
+}
+
+QString EndpointSelector::selectPreferring(const QString& url) const {
+    for (const Endpoint& endpoint : items) {
+        if (endpoint.url == url && endpoint.healthy) {
+            return url;
+        }
+    }
+    return select();
+}
+
+void EndpointSelector::reportSuccess(const QString& url, double latencyMs) {
+    Endpoint* endpoint = find(url);
+    if (!endpoint) {
+        return;
+    }
+    endpoint->ewmaMs = endpoint->ewmaMs < 0.0
+        ? latencyMs
+        : endpoint->ewmaMs + kEwmaAlpha * (latencyMs - endpoint->ewmaMs);
+    setHealthy(*endpoint, true);
+}
+
+void EndpointSelector::reportFailure(const QString& url) {
+    Endpoint* endpoint = find(url);
+    if (!endpoint) {
+        return;
+    }
+    endpoint->lastFailureMs = clock.elapsed();
+    setHealthy(*endpoint, false);
+}
+
+void EndpointSelector::setHealthCheckInterval(int ms) {
+    healthTimer.setInterval(qMax(100, ms));
+}
+
+EndpointSelector::Endpoint* EndpointSelector::find(const QString& url) {
+    for (Endpoint& endpoint : items) {
+        if (endpoint.url == url) {
+            return &endpoint;
+        }
+    }
+    return nullptr;
+}
+
+void EndpointSelector::runHealthChecks() {
+    for (Endpoint& endpoint : items) {
+        if (endpoint.checking) {
+            continue;
+        }
+        endpoint.checking = true;
+
+        // GET, а не HEAD: серверы, отвечающие на HEAD с телом, ломают
+        // следующее сообщение в keep-alive соединении
+        QNetworkRequest request(QUrl(endpoint.url + "/"));
+        request.setTransferTimeout(kHealthCheckTimeoutMs);
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+        QNetworkReply* reply = manager->get(request);
+        const QString url = endpoint.url;
+        const qint64 startedMs = clock.elapsed();
+
+        connect(reply, &QNetworkReply::finished, this, [this, reply, url, startedMs]() {
+            reply->deleteLater();
+            Endpoint* checked = find(url);
+            if (!checked) {
+                return; // Сервер убрали из списка
+            }
+            checked->checking = false;
+
+            // Любой HTTP-ответ, даже 404, означает, что сервер жив
+            if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid()) {
+                reportSuccess(url, double(clock.elapsed() - startedMs));
+            } else {
+                reportFailure(url);
+            }
+        });
+    }
+}
+
+void EndpointSelector::setHealthy(Endpoint& endpoint, bool healthy) {
+    if (endpoint.healthy == healthy) {
+        return;
+    }
+    endpoint.healthy = healthy;
+    qDebug() << "[EndpointSelector]" << endpoint.url << (healthy ? "is back online" : "is unavailable");
+    emit endpointStateChanged(endpoint.url, healthy);
+}
@@ -0,0 +1,38 @@
+#include "PageHandler.h"
+
+PageHandler::PageHandler(int offset, int limit, QObject* parent)
+    : ResponseHandler(parent), m_offset(offset), m_limit(limit) {}
+
+void PageHandler::process(const QJsonObject& response) {
+    QJsonArray items;
+    if (response["results"].isArray()) {
+        items = response["results"].toArray();
+    } else if (response["courses"].isArray()) {
+        items = response["courses"].toArray();
+    } else if (response["subtopics"].isArray()) {
+        items = response["subtopics"].toArray();
+    } else {
+        emit error("Invalid page format");
+        return;
+    }
+
+    // Сервер может не сообщать общее количество - тогда конец списка
+    // определяем по неполной странице
+    int totalCount = -1;
+    if (!response.contains("count") && items.size() > m_limit) {
+        // Сервер без постраничной выдачи вернул весь список целиком:
+        // отдаем только запрошенное окно, размер списка теперь известен
+        totalCount = items.size();
+        QJsonArray page;
+        for (int i = m_offset; i < items.size() && i < m_offset + m_limit; ++i) {
+            page.append(items.at(i));
+        }
+        items = page;
+    } else if (response.contains("count")) {
+        totalCount = response["count"].toInt();
+    } else if (items.size() < m_limit) {
+        totalCount = m_offset + items.size();
+    }
+
+    emit pageReceived(m_offset, items, totalCount);
+}
@@ -0,0 +1,245 @@
+#include "PagedListing.h"
+#include "CNetworkWrapper.h"
+
+PagedListing::PagedListing(CNetworkWrapper* network, int pageSize, int windowPages, QObject* parent)
+    : QObject(parent),
+      network(network),
+      m_pageSize(qMax(1, pageSize)),
+      windowPages(qMax(2, windowPages))
+{
+    connect(network, &CNetworkWrapper::coursesPageReceived,
+            this, [this](int offset, const QJsonArray& courses, int totalCount, quint64 requestId) {
+                if (source == Source::Courses) {
+                    onPageReceived(offset, courses, totalCount, requestId);
+                }
+            });
+
+    connect(network, &CNetworkWrapper::subtopicsPageReceived,
+            this, [this](int course, int parent, int offset, const QJsonArray& subtopics,
+                         int totalCount, quint64 requestId) {
+                if (source == Source::Topics && course == courseId && parent == parentTopicId) {
+                    onPageReceived(offset, subtopics, totalCount, requestId);
+                }
+            });
+
+    // Изменения, пришедшие по подписке
+    connect(network, &CNetworkWrapper::courseChanged,
+            this, [this](const QJsonObject& course, bool created) {
+                if (source == Source::Courses) {
+                    onItemChanged(course, created);
+                }
+            });
+    connect(network, &CNetworkWrapper::courseRemoved,
+            this, [this](int id) {
+                if (source == Source::Courses) {
+                    onItemRemoved(id);
+                }
+            });
+    connect(network, &CNetworkWrapper::topicChanged,
+            this, [this](int course, int parent, const QJsonObject& topic, bool created) {
+                if (source == Source::Topics && course == courseId && parent == parentTopicId) {
+                    onItemChanged(topic, created);
+                }
+            });
+    // Родитель удаленной темы неизвестен - проверяем любой список тем этого курса
+    connect(network, &CNetworkWrapper::topicRemoved,
+            this, [this](int course, int topicId) {
+                if (source == Source::Topics && course == courseId) {
+                    onItemRemoved(topicId);
+                }
+            });
+
+    connect(network, &CNetworkWrapper::coursesPageFailed,
+            this, [this](int offset, quint64 requestId) {
+                if (source == Source::Courses) {
+                    onPageFailed(offset, requestId);
+                }
+            });
+
+    connect(network, &CNetworkWrapper::subtopicsPageFailed,
+            this, [this](int course, int parent, int offset, quint64 requestId) {
+                if (source == Source::Topics && course == courseId && parent == parentTopicId) {
+                    onPageFailed(offset, requestId);
+                }
+            });
+}
+
+void PagedListing::setCoursesSource() {
+    reset(Source::Courses);
+    ensureLoaded(0);
+}
+
+void PagedListing::setTopicsSource(int courseId, int parentTopicId) {
+    reset(Source::Topics);
+    this->courseId = courseId;
+    this->parentTopicId = parentTopicId;
+    ensureLoaded(0);
+}
+
+void PagedListing::reset(Source newSource) {
+    source = newSource;
+    courseId = -1;
+    parentTopicId = -1;
+    currentPage = 0;
+    total = -1;
+    pages.clear();
+    pendingPages.clear();
+}
+
+void PagedListing::ensureLoaded(int index) {
+    if (source == Source::None || index < 0) {
+        return;
+    }
+
+    currentPage = index / m_pageSize;
+    evictOutsideWindow();
+
+    requestPage(currentPage);
+    // Следующую страницу грузим заранее, чтобы прокрутка не упиралась в сеть
+    requestPage(currentPage + 1);
+}
+
+bool PagedListing::isLoaded(int index) const {
+    return !itemAt(index).isUndefined();
+}
+
+QJsonValue PagedListing::itemAt(int index) const {
+    if (index < 0) {
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    auto it = pages.constFind(index / m_pageSize);
+    if (it == pages.constEnd() || index % m_pageSize >= it->size()) {
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    return it->at(index % m_pageSize);
+}
+
+int PagedListing::totalCount() const {
+    return total;
+}
+
+int PagedListing::pageSize() const {
+    return m_pageSize;
+}
+
+void PagedListing::requestPage(int page) {
+    if (pages.contains(page) || pendingPages.contains(page)) {
+        return;
+    }
+    // За концом списка запрашивать нечего
+    if (total >= 0 && page * m_pageSize >= total) {
+        return;
+    }
+
+    const quint64 requestId = source == Source::Courses
+        ? network->fetchCoursesPage(page * m_pageSize, m_pageSize)
+        : network->fetchTopicsPage(courseId, parentTopicId, page * m_pageSize, m_pageSize);
+    // 0 - запрос не отправлен (нет сессии); ensureLoaded() попробует снова
+    if (requestId != 0) {
+        pendingPages.insert(page, requestId);
+    }
+}
+
+bool PagedListing::takePending(int offset, quint64 requestId) {
+    // Ответы на чужие запросы, в том числе отправленные до сброса списка,
+    // отражают старые позиции или относятся к другому списку
+    if (offset % m_pageSize != 0) {
+        return false;
+    }
+    auto it = pendingPages.find(offset / m_pageSize);
+    if (it == pendingPages.end() || *it != requestId) {
+        return false;
+    }
+    pendingPages.erase(it);
+    return true;
+}
+
+void PagedListing::onPageReceived(int offset, const QJsonArray& items, int totalCount,
+                                  quint64 requestId) {
+    if (!takePending(offset, requestId)) {
+        return;
+    }
+    const int page = offset / m_pageSize;
+
+    if (totalCount >= 0 && totalCount != total) {
+        total = totalCount;
+        emit totalCountChanged(total);
+    }
+
+    // Пока ответ шел, пользователь мог уйти далеко от этой страницы
+    if (!inWindow(page)) {
+        return;
+    }
+
+    pages.insert(page, items);
+    emit pageLoaded(offset, items);
+}
+
+void PagedListing::onPageFailed(int offset, quint64 requestId) {
+    if (!takePending(offset, requestId)) {
+        return;
+    }
+    // Страница больше не считается запрошенной - следующий ensureLoaded() повторит запрос
+    emit pageFailed(offset);
+}
+
+void PagedListing::onItemChanged(const QJsonObject& item, bool created) {
+    const int id = item["id"].toInt();
+    for (auto it = pages.begin(); it != pages.end(); ++it) {
+        for (int i = 0; i < it->size(); ++i) {
+            if (it->at(i).toObject()["id"].toInt() == id) {
+                it->replace(i, item);
+                emit itemChanged(it.key() * m_pageSize + i, item);
+                return;
+            }
+        }
+    }
+    // Изменение элемента за окном позиций не сдвигает: его загрузят со свежими данными.
+    // Новый элемент мог встать в любое место списка
+    if (created) {
+        invalidate();
+    }
+}
+
+void PagedListing::onItemRemoved(int id) {
+    for (const QJsonArray& page : pages) {
+        for (const auto& value : page) {
+            if (value.toObject()["id"].toInt() == id) {
+                invalidate();
+                return;
+            }
+        }
+    }
+    // Удаленный элемент за окном сдвигает следующие страницы
+    if (total < 0 || (currentPage + 1) * m_pageSize < total) {
+        invalidate();
+    }
+}
+
+void PagedListing::invalidate() {
+    pages.clear();
+    // Ответы на уже отправленные запросы отражают старые позиции: их номера
+    // забываем, и takePending() их отбросит
+    pendingPages.clear();
+    total = -1;
+    emit invalidated();
+    ensureLoaded(currentPage * m_pageSize);
+}
+
+bool PagedListing::inWindow(int page) const {
+    // Окно: текущая страница, одна впереди и остальные позади
+    return page <= currentPage + 1 && page >= currentPage - (windowPages - 2);
+}
+
+void PagedListing::evictOutsideWindow() {
+    for (auto it = pages.begin(); it != pages.end();) {
+        if (inWindow(it.key())) {
+            ++it;
+            continue;
+        }
+        const int firstIndex = it.key() * m_pageSize;
+        const int count = it->size();
+        it = pages.erase(it);
+        emit pageEvicted(firstIndex, count);
+    }
+}
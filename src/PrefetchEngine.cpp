@@ -0,0 +1,359 @@
+#include "PrefetchEngine.h"
+#include "CNetworkWrapper.h"
+#include <QJsonObject>
+#include <QTimer>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QMetaObject>
+#include <QDebug>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+const double kHalfLifeMs = 3.0 * 24 * 3600 * 1000;  ///< Период полураспада частоты обращений
+const double kCatalogPrior = 0.1;   ///< Вес порядка в каталоге; меньше одного открытия
+const double kForgetScore = 0.01;   ///< Ниже этого запись истории не хранится
+}
+
+PrefetchEngine::PrefetchEngine(CNetworkWrapper* network, QObject* parent)
+    : QObject(parent),
+      network(network),
+      historyDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/prefetch"),
+      saveTimer(this)
+{
+    clock.start();
+    worker.setMaxThreadCount(1);
+    // Частые открытия курсов объединяются в одну запись
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(2000);
+    connect(&saveTimer, &QTimer::timeout, this, &PrefetchEngine::flushHistory);
+
+    // История загружается в фоне после входа, конструктор диска не ждет
+    connect(network, &CNetworkWrapper::authSuccess,
+            this, [this]() { switchUser(this->network->currentUser()); });
+    QTimer::singleShot(0, this, [this]() { switchUser(this->network->currentUser()); });
+
+    connect(network, &CNetworkWrapper::coursesReceived,
+            this, [this](const QJsonArray& courses) {
+                knownCourses.clear();
+                addCourses(courses);
+            });
+    connect(network, &CNetworkWrapper::coursesPageReceived,
+            this, [this](int offset, const QJsonArray& courses, int) {
+                if (offset == 0) {
+                    knownCourses.clear();
+                }
+                addCourses(courses);
+            });
+    // После интерактивного ответа соединение свободно - продолжаем отмененное
+    connect(network, &CNetworkWrapper::subtopicsFetched,
+            this, [this]() { QTimer::singleShot(0, this, &PrefetchEngine::schedule); });
+}
+
+PrefetchEngine::~PrefetchEngine() {
+    flushHistory();
+    worker.waitForDone();
+}
+
+void PrefetchEngine::setHistoryDirectory(const QString& dir) {
+    if (dir == historyDir) {
+        return;
+    }
+    flushHistory();
+    historyDir = dir;
+    // Перечитываем историю текущего пользователя из нового каталога
+    const QString user = historyUser;
+    historyUser.clear();
+    history.clear();
+    switchUser(user);
+}
+
+void PrefetchEngine::setMaxCandidates(int count) {
+    maxCandidates = qMax(0, count);
+}
+
+void PrefetchEngine::setBudget(int maxRequests, qint64 maxBytes, int windowMs) {
+    this->maxRequests = qMax(0, maxRequests);
+    this->maxBytes = qMax<qint64>(0, maxBytes);
+    this->windowMs = qMax(1, windowMs);
+}
+
+void PrefetchEngine::setCacheTtl(int ttlMs) {
+    cacheTtlMs = qMax(0, ttlMs);
+}
+
+PrefetchEngine::Stats PrefetchEngine::stats() const {
+    return counters;
+}
+
+bool PrefetchEngine::takePrefetched(int courseId, QJsonArray& subtopics) {
+    const qint64 now = clock.elapsed();
+    expireCache(now);
+
+    // Затухающий счетчик: давние обращения весят меньше недавних
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    Access& access = history[courseId];
+    access.score = rank(courseId, nowMs) + 1.0;
+    access.lastAccessMs = nowMs;
+    historyDirty = true;
+    // Таймер не перезапускаем: при непрерывных открытиях запись все равно случится
+    if (!saveTimer.isActive()) {
+        saveTimer.start();
+    }
+
+    // Данные курса у пользователя уже есть - повторно не загружаем до истечения срока кэша
+    servedAt.insert(courseId, now);
+
+    auto it = cache.find(courseId);
+    if (it == cache.end()) {
+        ++counters.misses;
+        emit statsChanged(counters);
+        return false;
+    }
+
+    subtopics = it->subtopics;
+    cache.erase(it);
+    ++counters.hits;
+    emit statsChanged(counters);
+    return true;
+}
+
+void PrefetchEngine::storePrefetched(int courseId, const QJsonArray& subtopics, qint64 bytes) {
+    const qint64 now = clock.elapsed();
+    if (!inFlight.remove(courseId)) {
+        return; // Запрос отправлен до clear(), например прежним пользователем
+    }
+    received.enqueue(qMakePair(now, bytes));
+    counters.bytes += bytes;
+    cache.insert(courseId, {subtopics, now});
+    emit statsChanged(counters);
+    schedule();
+}
+
+void PrefetchEngine::prefetchFailed(int courseId, bool cancelled) {
+    inFlight.remove(courseId);
+    if (cancelled) {
+        ++counters.cancelled;
+    } else {
+        qDebug() << "[PrefetchEngine] Prefetch failed for course" << courseId;
+    }
+    emit statsChanged(counters);
+}
+
+void PrefetchEngine::invalidate(int courseId) {
+    if (cache.remove(courseId)) {
+        ++counters.wasted;
+        emit statsChanged(counters);
+    }
+}
+
+void PrefetchEngine::clear() {
+    cache.clear();
+    inFlight.clear();
+    servedAt.clear();
+    switchUser(QString());
+}
+
+double PrefetchEngine::rank(int courseId, qint64 nowMs) const {
+    auto it = history.constFind(courseId);
+    if (it == history.constEnd()) {
+        return 0.0;
+    }
+    return decayed(*it, nowMs);
+}
+
+double PrefetchEngine::decayed(const Access& access, qint64 nowMs) {
+    return access.score * std::exp2(-double(nowMs - access.lastAccessMs) / kHalfLifeMs);
+}
+
+void PrefetchEngine::switchUser(const QString& user) {
+    if (user == historyUser) {
+        return;
+    }
+    // История прежнего пользователя дописывается в его файл
+    flushHistory();
+    history.clear();
+    historyUser = user;
+
+    if (user.isEmpty() || historyDir.isEmpty()) {
+        return;
+    }
+    const QString path = historyPath(user);
+    worker.start([this, user, path]() {
+        const QHash<int, Access> loaded = readHistory(path);
+        // Деструктор ждет завершения задачи, поэтому this еще жив
+        QMetaObject::invokeMethod(this, [this, user, loaded]() {
+            applyHistory(user, loaded);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void PrefetchEngine::applyHistory(const QString& user, const QHash<int, Access>& loaded) {
+    if (user != historyUser) {
+        return; // Пока файл читался, сменился пользователь
+    }
+    // Открытия, сделанные во время загрузки, новее записанных
+    for (auto it = loaded.cbegin(); it != loaded.cend(); ++it) {
+        if (!history.contains(it.key())) {
+            history.insert(it.key(), it.value());
+        }
+    }
+    schedule();
+}
+
+void PrefetchEngine::flushHistory() {
+    saveTimer.stop();
+    if (!historyDirty) {
+        return;
+    }
+    historyDirty = false;
+    if (historyUser.isEmpty() || historyDir.isEmpty()) {
+        return;
+    }
+
+    // Давно не открывавшиеся курсы забываем, чтобы история не росла
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    QHash<int, Access> entries;
+    for (auto it = history.cbegin(); it != history.cend(); ++it) {
+        if (decayed(it.value(), nowMs) >= kForgetScore) {
+            entries.insert(it.key(), it.value());
+        }
+    }
+
+    const QString path = historyPath(historyUser);
+    worker.start([path, entries]() {
+        if (!writeHistory(path, entries)) {
+            qDebug() << "[PrefetchEngine] Failed to write history to" << path;
+        }
+    });
+}
+
+QString PrefetchEngine::historyPath(const QString& user) const {
+    // Адрес почты в имени файла не храним
+    const QByteArray key = QCryptographicHash::hash(user.toLower().toUtf8(),
+                                                    QCryptographicHash::Sha1).toHex();
+    return historyDir + "/" + QString::fromLatin1(key) + ".json";
+}
+
+QHash<int, PrefetchEngine::Access> PrefetchEngine::readHistory(const QString& path) {
+    QHash<int, Access> entries;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return entries;
+    }
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = object.begin(); it != object.end(); ++it) {
+        const QJsonArray entry = it.value().toArray();
+        if (entry.size() != 2) {
+            continue;
+        }
+        const Access access{entry.at(0).toDouble(), qint64(entry.at(1).toDouble())};
+        if (decayed(access, nowMs) >= kForgetScore) {
+            entries.insert(it.key().toInt(), access);
+        }
+    }
+    return entries;
+}
+
+bool PrefetchEngine::writeHistory(const QString& path, const QHash<int, Access>& entries) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QJsonObject object;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        object.insert(QString::number(it.key()),
+                      QJsonArray{it.value().score, double(it.value().lastAccessMs)});
+    }
+
+    // QSaveFile заменяет файл атомарно: сбой посреди записи не портит историю
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+void PrefetchEngine::addCourses(const QJsonArray& courses) {
+    for (const auto& value : courses) {
+        const QJsonObject course = value.toObject();
+        if (course.contains("id")) {
+            knownCourses.append(course["id"].toInt());
+        }
+    }
+    schedule();
+}
+
+void PrefetchEngine::schedule() {
+    if (maxCandidates == 0 || !network->hasActiveSession()) {
+        return;
+    }
+    const qint64 now = clock.elapsed();
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    expireCache(now);
+
+    // Кандидаты по убыванию частоты и новизны открытий; курсы без истории
+    // идут после них в порядке каталога
+    QList<QPair<double, int>> ranked;
+    for (int i = 0; i < knownCourses.size(); ++i) {
+        const int courseId = knownCourses.at(i);
+        auto served = servedAt.constFind(courseId);
+        if (served != servedAt.constEnd() && now - *served < cacheTtlMs) {
+            continue; // Только что открыт интерактивно
+        }
+        const double prior = kCatalogPrior / (i + 1);
+        ranked.append(qMakePair(rank(courseId, nowMs) + prior, courseId));
+    }
+    std::sort(ranked.begin(), ranked.end(),
+              [](const QPair<double, int>& a, const QPair<double, int>& b) { return a.first > b.first; });
+
+    const int issuedBefore = counters.issued;
+    for (int i = 0; i < ranked.size() && i < maxCandidates; ++i) {
+        const int courseId = ranked.at(i).second;
+        if (cache.contains(courseId) || inFlight.contains(courseId)) {
+            continue;
+        }
+        if (!budgetAllows(now)) {
+            break;
+        }
+        inFlight.insert(courseId);
+        issuedAt.enqueue(now);
+        ++counters.issued;
+        network->prefetchTopics(courseId);
+    }
+    if (counters.issued != issuedBefore) {
+        emit statsChanged(counters);
+    }
+}
+
+bool PrefetchEngine::budgetAllows(qint64 now) {
+    while (!issuedAt.isEmpty() && now - issuedAt.head() >= windowMs) {
+        issuedAt.dequeue();
+    }
+    qint64 bytesInWindow = 0;
+    while (!received.isEmpty() && now - received.head().first >= windowMs) {
+        received.dequeue();
+    }
+    for (const auto& entry : received) {
+        bytesInWindow += entry.second;
+    }
+    return issuedAt.size() < maxRequests && bytesInWindow < maxBytes;
+}
+
+void PrefetchEngine::expireCache(qint64 now) {
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (now - it->storedMs >= cacheTtlMs) {
+            it = cache.erase(it);
+            ++counters.wasted;
+        } else {
+            ++it;
+        }
+    }
+}
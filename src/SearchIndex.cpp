@@ -0,0 +1,537 @@
+#include "SearchIndex.h"
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+#include <QMetaObject>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const quint32 kIndexMagic = 0x53494458;  // "SIDX"
+const quint32 kIndexVersion = 1;
+const float kTitleWeight = 3.0f;
+const float kTextWeight = 1.0f;
+const int kMinTokenLength = 2;
+const int kFuzzyMinTokenLength = 3;
+const int kFuzzyThreshold = 10;  ///< Нечеткий поиск, только если точных совпадений мало
+const int kMaxExpandedPostings = 20000;  ///< Предел записей, набираемых префиксами и опечатками
+const int kSaveDelayMs = 2000;
+// Наименьший размер записей в файле: по ним отсекаются испорченные счетчики
+const qint64 kMinDocumentBytes = 13;  ///< Вид, id, пустой заголовок, число терминов
+const qint64 kMinTermBytes = 8;       ///< Пустое слово и вес
+
+QString titleOf(const QJsonObject& object) {
+    return object.contains("title") ? object["title"].toString() : object["name"].toString();
+}
+}
+
+SearchIndex::SearchIndex(QObject* parent)
+    : QObject(parent),
+      saveTimer(this)
+{
+    worker.setMaxThreadCount(1);
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(kSaveDelayMs);
+    connect(&saveTimer, &QTimer::timeout, this, &SearchIndex::saveInBackground);
+}
+
+SearchIndex::~SearchIndex() {
+    if (saveTimer.isActive()) {
+        saveInBackground();
+    }
+    worker.waitForDone();
+}
+
+void SearchIndex::upsert(EntryKind kind, int id, const QString& title, const QString& text) {
+    // Для каждого слова оставляем наибольший вес
+    QHash<QString, float> weights;
+    for (const QString& word : tokenize(title)) {
+        weights[word] = kTitleWeight;
+    }
+    for (const QString& word : tokenize(text)) {
+        if (!weights.contains(word)) {
+            weights.insert(word, kTextWeight);
+        }
+    }
+
+    Document document{kind, id, title, {}};
+    document.terms.reserve(weights.size());
+    for (auto it = weights.cbegin(); it != weights.cend(); ++it) {
+        document.terms.append({it.key(), it.value()});
+    }
+    std::sort(document.terms.begin(), document.terms.end(),
+              [](const Term& a, const Term& b) { return a.word < b.word; });
+
+    const quint64 docKey = key(kind, id);
+    auto existing = documents.constFind(docKey);
+    if (existing != documents.constEnd() && existing->title == title &&
+        existing->terms.size() == document.terms.size() &&
+        std::equal(existing->terms.cbegin(), existing->terms.cend(), document.terms.cbegin(),
+                   [](const Term& a, const Term& b) { return a.word == b.word && a.weight == b.weight; }))
+    {
+        return; // Запись не изменилась
+    }
+
+    removeDocument(docKey);
+    insertDocument(docKey, document);
+    scheduleSave();
+    emit indexChanged();
+}
+
+void SearchIndex::remove(EntryKind kind, int id) {
+    const quint64 docKey = key(kind, id);
+    if (!documents.contains(docKey)) {
+        return;
+    }
+    removeDocument(docKey);
+    scheduleSave();
+    emit indexChanged();
+}
+
+void SearchIndex::indexCourses(const QJsonArray& courses) {
+    for (const auto& value : courses) {
+        const QJsonObject course = value.toObject();
+        if (course.contains("id")) {
+            upsert(EntryKind::Course, course["id"].toInt(), titleOf(course),
+                   course["description"].toString());
+        }
+    }
+}
+
+void SearchIndex::indexTopics(const QJsonArray& topics) {
+    for (const auto& value : topics) {
+        const QJsonObject topic = value.toObject();
+        if (!topic.contains("id")) {
+            continue;
+        }
+        upsert(EntryKind::Topic, topic["id"].toInt(), titleOf(topic),
+               topic["description"].toString());
+
+        if (topic["subtopics"].isArray()) {
+            indexTopics(topic["subtopics"].toArray());
+        }
+        if (topic["materials"].isArray()) {
+            indexMaterials(topic["materials"].toArray());
+        }
+    }
+}
+
+void SearchIndex::indexMaterials(const QJsonArray& materials) {
+    for (const auto& value : materials) {
+        const QJsonObject material = value.toObject();
+        if (material.contains("id")) {
+            upsert(EntryKind::Material, material["id"].toInt(), titleOf(material),
+                   material["description"].toString());
+        }
+    }
+}
+
+QVector<SearchIndex::Result> SearchIndex::search(const QString& query, int limit) const {
+    const QStringList tokens = tokenize(query);
+    if (tokens.isEmpty() || limit <= 0) {
+        return {};
+    }
+
+    QVector<QVector<Match>> matches;
+    matches.reserve(tokens.size());
+    for (const QString& token : tokens) {
+        QVector<Match> tokenMatches = matchToken(token);
+        if (tokenMatches.isEmpty()) {
+            return {};
+        }
+        matches.append(tokenMatches);
+    }
+
+    // Кандидатов дает самое редкое слово запроса, остальные только проверяются:
+    // таблица всех совпадений частого слова не строится
+    const auto postingCount = [](const QVector<Match>& tokenMatches) {
+        qsizetype count = 0;
+        for (const Match& match : tokenMatches) {
+            count += match.docs->size();
+        }
+        return count;
+    };
+    std::sort(matches.begin(), matches.end(),
+              [&postingCount](const QVector<Match>& a, const QVector<Match>& b) {
+                  return postingCount(a) < postingCount(b);
+              });
+
+    QVector<QPair<double, quint64>> candidates;
+    const QVector<Match>& rarest = matches.first();
+    if (rarest.size() == 1) {
+        // Одно слово словаря: запись встречается в нем один раз
+        const Match& match = rarest.first();
+        candidates.reserve(match.docs->size());
+        for (auto it = match.docs->cbegin(); it != match.docs->cend(); ++it) {
+            candidates.append(qMakePair(match.factor * it.value(), it.key()));
+        }
+    } else {
+        // Запись может содержать несколько подходящих слов - берем лучшее
+        QHash<quint64, double> best;
+        best.reserve(postingCount(rarest));
+        for (const Match& match : rarest) {
+            for (auto it = match.docs->cbegin(); it != match.docs->cend(); ++it) {
+                double& score = best[it.key()];
+                score = qMax(score, match.factor * it.value());
+            }
+        }
+        candidates.reserve(best.size());
+        for (auto it = best.cbegin(); it != best.cend(); ++it) {
+            candidates.append(qMakePair(it.value(), it.key()));
+        }
+    }
+
+    // Запись должна совпасть с каждым словом запроса
+    if (matches.size() > 1) {
+        int kept = 0;
+        for (const auto& candidate : candidates) {
+            double total = candidate.first;
+            bool matchesAll = true;
+            for (int t = 1; t < matches.size() && matchesAll; ++t) {
+                double best = 0.0;
+                for (const Match& match : matches.at(t)) {
+                    auto found = match.docs->constFind(candidate.second);
+                    if (found != match.docs->constEnd()) {
+                        best = qMax(best, match.factor * found.value());
+                    }
+                }
+                matchesAll = best > 0.0;
+                total += best;
+            }
+            if (matchesAll) {
+                candidates[kept++] = qMakePair(total, candidate.second);
+            }
+        }
+        candidates.resize(kept);
+    }
+
+    // Лучшие по оценке; записи с равной оценкой - в порядке ключа, чтобы
+    // заголовки читались только для показываемых результатов
+    const int count = qMin(limit, int(candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [](const QPair<double, quint64>& a, const QPair<double, quint64>& b) {
+                          return a.first != b.first ? a.first > b.first : a.second < b.second;
+                      });
+
+    QVector<Result> results;
+    results.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const Document& document = *documents.constFind(candidates.at(i).second);
+        results.append({document.kind, document.id, document.title, candidates.at(i).first});
+    }
+    std::stable_sort(results.begin(), results.end(), [](const Result& a, const Result& b) {
+        return a.score != b.score ? a.score > b.score : a.title < b.title;
+    });
+    return results;
+}
+
+int SearchIndex::size() const {
+    return documents.size();
+}
+
+void SearchIndex::clear() {
+    if (documents.isEmpty()) {
+        return;
+    }
+    documents.clear();
+    postings.clear();
+    // Загрузка, начатая до очистки, уже не нужна
+    ++generation;
+    scheduleSave();
+    emit indexChanged();
+}
+
+void SearchIndex::setStoragePath(const QString& path) {
+    storagePath = path;
+    loading = true;
+
+    const quint64 startedAt = generation;
+    worker.start([this, path, startedAt]() {
+        QHash<quint64, Document> loaded;
+        Postings loadedPostings;
+        const bool exists = QFile::exists(path);
+        const bool ok = !exists || readFile(path, loaded, loadedPostings);
+
+        // Деструктор ждет завершения задачи, поэтому this еще жив
+        QMetaObject::invokeMethod(this, [this, path, startedAt, ok, loaded, loadedPostings]() {
+            if (path != storagePath) {
+                return; // Файл индекса успели сменить
+            }
+            loading = false;
+            if (!ok) {
+                qDebug() << "[SearchIndex] Ignoring unreadable index file" << path;
+            } else if (startedAt == generation) {
+                applyLoaded(loaded, loadedPostings);
+            }
+            // Изменения, пришедшие во время загрузки, еще не сохранены
+            if (documents.size() != loaded.size() || startedAt != generation) {
+                scheduleSave();
+            }
+            emit storageLoaded(ok);
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool SearchIndex::isLoading() const {
+    return loading;
+}
+
+void SearchIndex::applyLoaded(const QHash<quint64, Document>& loaded, const Postings& loadedPostings) {
+    if (loaded.isEmpty()) {
+        return;
+    }
+    if (documents.isEmpty()) {
+        // Обычный случай при запуске: словарь уже построен в фоне
+        documents = loaded;
+        postings = loadedPostings;
+    } else {
+        // Пока шла загрузка, пришли свежие данные из сети - они важнее
+        for (auto it = loaded.cbegin(); it != loaded.cend(); ++it) {
+            if (!documents.contains(it.key())) {
+                insertDocument(it.key(), it.value());
+            }
+        }
+    }
+    emit indexChanged();
+}
+
+void SearchIndex::saveInBackground() {
+    saveTimer.stop();
+    // Неполный индекс не должен затереть файл, который еще читается;
+    // после загрузки изменения сохранятся заново
+    if (loading || storagePath.isEmpty()) {
+        return;
+    }
+
+    // Копия разделяет данные с индексом и отделится только при его изменении
+    const QHash<quint64, Document> snapshot = documents;
+    const QString path = storagePath;
+    worker.start([path, snapshot]() {
+        if (!writeFile(path, snapshot)) {
+            qDebug() << "[SearchIndex] Failed to save index to" << path;
+        }
+    });
+}
+
+bool SearchIndex::save(const QString& path) const {
+    return writeFile(path, documents);
+}
+
+bool SearchIndex::writeFile(const QString& path, const QHash<quint64, Document>& documents) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // QSaveFile пишет во временный файл и подменяет им старый при commit()
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kIndexMagic << kIndexVersion << qint32(documents.size());
+    for (const Document& document : documents) {
+        out << quint8(document.kind) << qint32(document.id) << document.title
+            << qint32(document.terms.size());
+        for (const Term& term : document.terms) {
+            out << term.word << term.weight;
+        }
+    }
+
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+bool SearchIndex::load(const QString& path) {
+    QHash<quint64, Document> loaded;
+    Postings loadedPostings;
+    if (!readFile(path, loaded, loadedPostings)) {
+        return false;
+    }
+    documents = loaded;
+    postings = loadedPostings;
+    emit indexChanged();
+    return true;
+}
+
+bool SearchIndex::readFile(const QString& path, QHash<quint64, Document>& loaded, Postings& loadedPostings) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    // Счетчик из испорченного файла не должен заставить выделить гигабайты
+    if (magic != kIndexMagic || version != kIndexVersion || count < 0
+        || count > file.bytesAvailable() / kMinDocumentBytes) {
+        return false;
+    }
+
+    loaded.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        quint8 kind = 0;
+        qint32 id = 0;
+        qint32 termCount = 0;
+        Document document;
+        in >> kind >> id >> document.title >> termCount;
+        if (termCount < 0 || termCount > file.bytesAvailable() / kMinTermBytes) {
+            return false;
+        }
+        document.kind = EntryKind(kind);
+        document.id = id;
+        document.terms.reserve(termCount);
+        for (qint32 t = 0; t < termCount && in.status() == QDataStream::Ok; ++t) {
+            Term term;
+            in >> term.word >> term.weight;
+            document.terms.append(term);
+        }
+        const quint64 docKey = key(document.kind, id);
+        for (const Term& term : document.terms) {
+            loadedPostings[term.word].insert(docKey, term.weight);
+        }
+        loaded.insert(docKey, document);
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+quint64 SearchIndex::key(EntryKind kind, int id) {
+    return (quint64(kind) << 32) | quint32(id);
+}
+
+QStringList SearchIndex::tokenize(const QString& text) {
+    QStringList tokens;
+    QString current;
+    for (const QChar ch : text) {
+        if (ch.isLetterOrNumber()) {
+            current.append(ch.toLower());
+        } else if (!current.isEmpty()) {
+            if (current.size() >= kMinTokenLength) {
+                tokens.append(current);
+            }
+            current.clear();
+        }
+    }
+    if (current.size() >= kMinTokenLength) {
+        tokens.append(current);
+    }
+    return tokens;
+}
+
+int SearchIndex::boundedDistance(const QString& a, const QString& b, int maxDistance) {
+    // Левенштейн с ранним выходом, как только расстояние превысило порог
+    if (qAbs(a.size() - b.size()) > maxDistance) {
+        return maxDistance + 1;
+    }
+
+    QVector<int> previous(b.size() + 1);
+    QVector<int> current(b.size() + 1);
+    for (int j = 0; j <= b.size(); ++j) {
+        previous[j] = j;
+    }
+
+    for (int i = 1; i <= a.size(); ++i) {
+        current[0] = i;
+        int rowMin = current[0];
+        for (int j = 1; j <= b.size(); ++j) {
+            const int cost = a.at(i - 1) == b.at(j - 1) ? 0 : 1;
+            current[j] = qMin(qMin(previous[j] + 1, current[j - 1] + 1), previous[j - 1] + cost);
+            rowMin = qMin(rowMin, current[j]);
+        }
+        if (rowMin > maxDistance) {
+            return maxDistance + 1;
+        }
+        previous.swap(current);
+    }
+    return previous[b.size()];
+}
+
+void SearchIndex::insertDocument(quint64 docKey, const Document& document) {
+    documents.insert(docKey, document);
+    for (const Term& term : document.terms) {
+        postings[term.word].insert(docKey, term.weight);
+    }
+}
+
+void SearchIndex::removeDocument(quint64 docKey) {
+    auto it = documents.find(docKey);
+    if (it == documents.end()) {
+        return;
+    }
+    for (const Term& term : it->terms) {
+        auto posting = postings.find(term.word);
+        if (posting == postings.end()) {
+            continue;
+        }
+        posting->remove(docKey);
+        if (posting->isEmpty()) {
+            postings.erase(posting);
+        }
+    }
+    documents.erase(it);
+}
+
+QVector<SearchIndex::Match> SearchIndex::matchToken(const QString& token) const {
+    QVector<Match> matches;
+    qsizetype found = 0;
+
+    // Точное совпадение и совпадение по префиксу идут в словаре подряд
+    for (auto it = postings.lowerBound(token);
+         it != postings.cend() && it.key().startsWith(token); ++it)
+    {
+        const double factor = it.key().size() == token.size()
+            ? 1.0
+            : 0.5 + 0.4 * token.size() / it.key().size();
+        matches.append({&it.value(), factor});
+        found += it.value().size();
+    }
+
+    if (found < kFuzzyThreshold && token.size() >= kFuzzyMinTokenLength) {
+        // Опечатки ищем среди слов с той же первой буквой
+        const int maxDistance = token.size() >= 6 ? 2 : 1;
+        const QString first = token.left(1);
+        for (auto it = postings.lowerBound(first);
+             it != postings.cend() && it.key().startsWith(first); ++it)
+        {
+            const QString& word = it.key();
+            if (word.startsWith(token)) {
+                continue; // Уже учтено выше
+            }
+            int distance = boundedDistance(token, word, maxDistance);
+            if (word.size() > token.size()) {
+                // Опечатка в еще не дописанном слове
+                distance = qMin(distance, boundedDistance(token, word.left(token.size()), maxDistance));
+            }
+            if (distance <= maxDistance) {
+                matches.append({&it.value(), distance == 1 ? 0.4 : 0.25});
+            }
+        }
+    }
+
+    // Короткий префикс может подходить к сотням слов с десятками тысяч записей:
+    // берем самые близкие слова, пока не наберется предел (первое - всегда)
+    std::stable_sort(matches.begin(), matches.end(),
+                     [](const Match& a, const Match& b) { return a.factor > b.factor; });
+    qsizetype taken = 0;
+    int keep = 0;
+    while (keep < matches.size() && (keep == 0 || taken < kMaxExpandedPostings)) {
+        taken += matches.at(keep++).docs->size();
+    }
+    matches.resize(keep);
+    return matches;
+}
+
+void SearchIndex::scheduleSave() {
+    if (!storagePath.isEmpty()) {
+        saveTimer.start();
+    }
+}
@@ -0,0 +1,29 @@
+#include "SettingsSessionStore.h"
+#include <QSettings>
+
+SettingsSessionStore::SettingsSessionStore(const QString& group, QObject* parent)
+    : SessionStore(parent), m_group(group) {}
+
+void SettingsSessionStore::load() {
+    QSettings settings;
+    SessionState state;
+    state.accessToken = settings.value(m_group + "/accessToken").toString();
+    state.refreshToken = settings.value(m_group + "/refreshToken").toString();
+    state.userName = settings.value(m_group + "/user").toString();
+    emit loaded(state);
+}
+
+void SettingsSessionStore::save(const SessionState& state) {
+    QSettings settings;
+    settings.setValue(m_group + "/accessToken", state.accessToken);
+    settings.setValue(m_group + "/refreshToken", state.refreshToken);
+    settings.setValue(m_group + "/user", state.userName);
+    settings.sync();
+    if (settings.status() != QSettings::NoError) {
+        emit error("Failed to save session settings");
+    }
+}
+
+void SettingsSessionStore::clear() {
+    QSettings().remove(m_group);
+}
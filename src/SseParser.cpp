@@ -0,0 +1,88 @@
+#include "SseParser.h"
+
+QVector<SseEvent> SseParser::feed(const QByteArray& chunk) {
+    buffer += chunk;
+    QVector<SseEvent> events;
+
+    int start = 0;
+    for (int i = 0; i < buffer.size(); ++i) {
+        const char ch = buffer.at(i);
+        if (ch != '\n' && ch != '\r') {
+            continue;
+        }
+        // "\r" в конце куска может оказаться началом "\r\n" - ждем продолжения
+        if (ch == '\r' && i + 1 == buffer.size()) {
+            break;
+        }
+        processLine(buffer.mid(start, i - start), events);
+        if (ch == '\r' && buffer.at(i + 1) == '\n') {
+            ++i;
+        }
+        start = i + 1;
+    }
+    buffer.remove(0, start);
+    return events;
+}
+
+void SseParser::reset() {
+    buffer.clear();
+    eventType.clear();
+    data.clear();
+    hasData = false;
+}
+
+void SseParser::clearLastEventId() {
+    lastEventId.clear();
+}
+
+int SseParser::retryInterval() const {
+    return retryMs;
+}
+
+void SseParser::processLine(const QByteArray& line, QVector<SseEvent>& events) {
+    // Пустая строка завершает событие
+    if (line.isEmpty()) {
+        if (hasData) {
+            SseEvent event;
+            event.id = lastEventId;
+            event.type = eventType.isEmpty() ? QString("message") : eventType;
+            event.data = data;
+            events.append(event);
+        }
+        eventType.clear();
+        data.clear();
+        hasData = false;
+        return;
+    }
+    // Комментарий, например keep-alive
+    if (line.startsWith(':')) {
+        return;
+    }
+
+    const int colon = line.indexOf(':');
+    const QByteArray field = colon < 0 ? line : line.left(colon);
+    QByteArray value = colon < 0 ? QByteArray() : line.mid(colon + 1);
+    if (value.startsWith(' ')) {
+        value.remove(0, 1);
+    }
+
+    if (field == "event") {
+        eventType = QString::fromUtf8(value);
+    } else if (field == "data") {
+        if (hasData) {
+            data += '\n';
+        }
+        data += QString::fromUtf8(value);
+        hasData = true;
+    } else if (field == "id") {
+        if (!value.contains('\0')) {
+            lastEventId = QString::fromUtf8(value);
+        }
+    } else if (field == "retry") {
+        bool ok = false;
+        const int ms = value.toInt(&ok);
+        if (ok && ms >= 0) {
+            retryMs = ms;
+        }
+    }
+}
@@ -0,0 +1,245 @@
+#include "TopicGraph.h"
+
+TopicGraph::TopicGraph(QObject* parent)
+    : QObject(parent) {}
+
+const TopicNode* TopicGraph::node(int topicId) const {
+    auto it = indexById.constFind(topicId);
+    return it == indexById.constEnd() ? nullptr : &nodes.at(*it);
+}
+
+bool TopicGraph::contains(int topicId) const {
+    return indexById.contains(topicId);
+}
+
+QVector<int> TopicGraph::children(int topicId) const {
+    const TopicNode* topic = node(topicId);
+    return topic ? topic->children : QVector<int>();
+}
+
+QVector<int> TopicGraph::rootTopics(int courseId) const {
+    return courseRoots.value(courseId);
+}
+
+QJsonArray TopicGraph::materials(int topicId) const {
+    const TopicNode* topic = node(topicId);
+    return topic ? topic->materials : QJsonArray();
+}
+
+int TopicGraph::size() const {
+    return indexById.size();
+}
+
+void TopicGraph::applySubtopics(int courseId, int parentTopicId, const QJsonArray& subtopics,
+                                bool complete) {
+    QVector<int> changed;
+    QVector<int> dropped;
+    QSet<int> seen;
+
+    // Подтемы еще не загруженной темы вешаем на заглушку, а не выбрасываем
+    if (parentTopicId != -1 && !contains(parentTopicId)) {
+        const int slot = allocate();
+        TopicNode& placeholder = nodes[slot];
+        placeholder = TopicNode();
+        placeholder.id = parentTopicId;
+        placeholder.courseId = courseId;
+        placeholder.alive = true;
+        placeholder.placeholder = true;
+        indexById.insert(parentTopicId, slot);
+        changed.append(parentTopicId);
+    }
+
+    mergeSubtopics(courseId, parentTopicId, subtopics, complete, changed, dropped, seen);
+
+    // Удаляем только после полного слияния: тема, пропавшая из одного списка,
+    // могла переехать в другой список этого же ответа
+    QVector<int> removed;
+    for (int id : dropped) {
+        if (!seen.contains(id)) {
+            detach(id, removed);
+        }
+    }
+
+    if (!removed.isEmpty()) {
+        emit topicsRemoved(removed);
+    }
+    if (!changed.isEmpty() || !removed.isEmpty()) {
+        emit subtreeChanged(courseId, parentTopicId, changed);
+    }
+}
+
+void TopicGraph::applyMaterials(int topicId, const QJsonArray& materials) {
+    TopicNode* topic = find(topicId);
+    if (!topic || topic->materials == materials) {
+        return;
+    }
+    topic->materials = materials;
+    emit materialsChanged(topicId);
+}
+
+void TopicGraph::removeTopic(int topicId) {
+    TopicNode* topic = find(topicId);
+    if (!topic) {
+        return;
+    }
+
+    const int courseId = topic->courseId;
+    const int parentId = topic->parentId;
+    if (QVector<int>* siblings = childList(courseId, parentId)) {
+        siblings->removeOne(topicId);
+    }
+
+    QVector<int> removed;
+    detach(topicId, removed);
+    emit topicsRemoved(removed);
+    emit subtreeChanged(courseId, parentId, QVector<int>());
+}
+
+void TopicGraph::clear() {
+    QVector<int> removed = indexById.keys();
+    nodes.clear();
+    indexById.clear();
+    freeSlots.clear();
+    courseRoots.clear();
+    if (!removed.isEmpty()) {
+        emit topicsRemoved(removed);
+    }
+}
+
+TopicNode* TopicGraph::find(int topicId) {
+    auto it = indexById.constFind(topicId);
+    return it == indexById.constEnd() ? nullptr : &nodes[*it];
+}
+
+QVector<int>* TopicGraph::childList(int courseId, int parentTopicId) {
+    if (parentTopicId == -1) {
+        return &courseRoots[courseId];
+    }
+    TopicNode* parent = find(parentTopicId);
+    return parent ? &parent->children : nullptr;
+}
+
+int TopicGraph::allocate() {
+    if (!freeSlots.isEmpty()) {
+        return freeSlots.takeLast();
+    }
+    nodes.append(TopicNode());
+    return nodes.size() - 1;
+}
+
+void TopicGraph::mergeSubtopics(int courseId, int parentTopicId, const QJsonArray& subtopics,
+                                bool complete, QVector<int>& changed, QVector<int>& dropped,
+                                QSet<int>& seen) {
+    QVector<int> incoming;
+    incoming.reserve(subtopics.size());
+
+    for (const auto& value : subtopics) {
+        if (!value.isObject()) {
+            continue;
+        }
+        QJsonObject topic = value.toObject();
+        if (!topic.contains("id")) {
+            continue;
+        }
+        const int id = topic["id"].toInt();
+        const QJsonValue nestedSubtopics = topic.take("subtopics");
+        const QJsonValue nestedMaterials = topic.take("materials");
+        incoming.append(id);
+        seen.insert(id);
+
+        auto it = indexById.constFind(id);
+        if (it == indexById.constEnd()) {
+            const int slot = allocate();
+            TopicNode& created = nodes[slot];
+            created = TopicNode();
+            created.id = id;
+            created.courseId = courseId;
+            created.parentId = parentTopicId;
+            created.data = topic;
+            created.alive = true;
+            indexById.insert(id, slot);
+            changed.append(id);
+        } else {
+            TopicNode& existing = nodes[*it];
+            // Заглушка получила данные и место в дереве
+            if (existing.placeholder) {
+                existing.placeholder = false;
+                existing.parentId = parentTopicId;
+                moveToCourse(id, courseId, changed);
+                changed.append(id);
+            }
+            // Тема могла переехать к другому родителю
+            else if (existing.parentId != parentTopicId || existing.courseId != courseId) {
+                if (QVector<int>* oldSiblings = childList(existing.courseId, existing.parentId)) {
+                    oldSiblings->removeOne(id);
+                }
+                nodes[*it].parentId = parentTopicId;
+                // Поддерево переезжает вместе с темой
+                moveToCourse(id, courseId, changed);
+                changed.append(id);
+            } else if (existing.data != topic) {
+                changed.append(id);
+            }
+            nodes[*it].data = topic;
+        }
+
+        if (nestedMaterials.isArray()) {
+            TopicNode* current = find(id);
+            if (current->materials != nestedMaterials.toArray()) {
+                current->materials = nestedMaterials.toArray();
+                changed.append(id);
+            }
+        }
+        if (nestedSubtopics.isArray()) {
+            mergeSubtopics(courseId, id, nestedSubtopics.toArray(), true, changed, dropped, seen);
+        }
+    }
+
+    QVector<int>* siblings = childList(courseId, parentTopicId);
+    if (complete) {
+        const QSet<int> keep(incoming.cbegin(), incoming.cend());
+        for (int oldId : QVector<int>(*siblings)) {
+            if (!keep.contains(oldId)) {
+                dropped.append(oldId);
+            }
+        }
+        *siblings = incoming;
+    } else {
+        for (int id : incoming) {
+            if (!siblings->contains(id)) {
+                siblings->append(id);
+            }
+        }
+    }
+}
+
+void TopicGraph::moveToCourse(int topicId, int courseId, QVector<int>& changed) {
+    TopicNode* topic = find(topicId);
+    if (!topic || topic->courseId == courseId) {
+        return;
+    }
+    topic->courseId = courseId;
+    // find() возвращает адрес в nodes: копируем детей до рекурсии
+    const QVector<int> children = topic->children;
+    for (int childId : children) {
+        moveToCourse(childId, courseId, changed);
+        changed.append(childId);
+    }
+}
+
+void TopicGraph::detach(int topicId, QVector<int>& removed) {
+    auto it = indexById.constFind(topicId);
+    if (it == indexById.constEnd()) {
+        return;
+    }
+    const int slot = *it;
+    const QVector<int> subtree = nodes[slot].children;
+    for (int childId : subtree) {
+        detach(childId, removed);
+    }
+
+    nodes[slot] = TopicNode();
+    indexById.remove(topicId);
+    freeSlots.append(slot);
+    removed.append(topicId);
+}
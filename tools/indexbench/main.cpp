@@ -0,0 +1,129 @@
+// Файл: main.cpp
+// Замер скорости SearchIndex на синтетическом каталоге
+
+#include "SearchIndex.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QStringList>
+#include <QVector>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+/// Словарь, из которого собираются заголовки и описания
+const QStringList kWords = {
+    "алгебра", "геометрия", "физика", "химия", "биология", "история", "литература",
+    "программирование", "алгоритмы", "структуры", "данных", "сети", "базы", "криптография",
+    "шифрование", "симметричное", "асимметричное", "хеширование", "подпись", "протокол",
+    "введение", "основы", "продвинутый", "практикум", "лекция", "семинар", "задачи",
+    "matrix", "vector", "graph", "tree", "network", "security", "analysis", "design",
+    "theory", "practice", "systems", "linear", "discrete", "probability", "statistics"
+};
+
+QString randomText(QRandomGenerator& random, int words) {
+    QStringList parts;
+    for (int i = 0; i < words; ++i) {
+        // Номер делает слова разнообразнее, как названия реальных тем
+        QString word = kWords.at(random.bounded(int(kWords.size())));
+        if (random.bounded(4) == 0) {
+            word += QString::number(random.bounded(100));
+        }
+        parts.append(word);
+    }
+    return parts.join(' ');
+}
+
+/// Запрос с опечаткой: одна буква заменена
+QString withTypo(QRandomGenerator& random, const QString& word) {
+    QString result = word;
+    result[random.bounded(int(word.size()))] = QChar('x');
+    return result;
+}
+
+double percentile(const QVector<double>& sorted, double p) {
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    const int rank = qBound(0, int(p / 100.0 * sorted.size() + 0.5) - 1, int(sorted.size()) - 1);
+    return sorted.at(rank);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("IndexBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Builds a synthetic SearchIndex and measures query latency; "
+                                     "exits with 1 if p99 exceeds the target");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"entries", "Number of indexed entries.", "count", "50000"},
+        {"queries", "Number of measured queries.", "count", "5000"},
+        {"target", "p99 query latency target, microseconds.", "us", "1000"},
+        {"seed", "Random seed.", "seed", "42"},
+    });
+    parser.process(app);
+
+    const int entries = qMax(1, parser.value("entries").toInt());
+    const int queries = qMax(1, parser.value("queries").toInt());
+    const double targetUs = parser.value("target").toDouble();
+    QRandomGenerator random(parser.value("seed").toUInt());
+    QTextStream out(stdout);
+
+    SearchIndex index;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < entries; ++i) {
+        // Соотношение как в каталоге: тем и материалов больше, чем курсов
+        const auto kind = i % 10 == 0 ? SearchIndex::EntryKind::Course
+                        : i % 3 == 0 ? SearchIndex::EntryKind::Material
+                                     : SearchIndex::EntryKind::Topic;
+        index.upsert(kind, i, randomText(random, 3), randomText(random, 12));
+    }
+    const qint64 buildMs = timer.elapsed();
+
+    QTemporaryDir dir;
+    const QString path = dir.filePath("bench.idx");
+    timer.restart();
+    index.save(path);
+    const qint64 saveMs = timer.elapsed();
+    timer.restart();
+    SearchIndex loaded;
+    loaded.load(path);
+    const qint64 loadMs = timer.elapsed();
+
+    // Точные слова, префиксы и опечатки поровну
+    QVector<double> latencies;
+    latencies.reserve(queries);
+    for (int i = 0; i < queries; ++i) {
+        const QString word = kWords.at(random.bounded(int(kWords.size())));
+        QString query;
+        switch (i % 3) {
+        case 0: query = word + ' ' + kWords.at(random.bounded(int(kWords.size()))); break;
+        case 1: query = word.left(qMax(2, int(word.size()) / 2)); break;
+        default: query = withTypo(random, word); break;
+        }
+        timer.restart();
+        const auto results = index.search(query);
+        latencies.append(timer.nsecsElapsed() / 1000.0);
+        Q_UNUSED(results);
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    out << "Entries: " << index.size() << ", build " << buildMs << " ms, save " << saveMs
+        << " ms, load " << loadMs << " ms\n";
+    out << "Query latency, us: p50 " << QString::number(percentile(latencies, 50), 'f', 1)
+        << ", p90 " << QString::number(percentile(latencies, 90), 'f', 1)
+        << ", p99 " << QString::number(percentile(latencies, 99), 'f', 1)
+        << ", max " << QString::number(latencies.last(), 'f', 1) << '\n';
+
+    const bool withinTarget = percentile(latencies, 99) <= targetUs;
+    out << (withinTarget ? "OK" : "FAIL") << ": target p99 <= " << targetUs << " us\n";
+    return withinTarget ? 0 : 1;
+}
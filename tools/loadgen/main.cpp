@@ -0,0 +1,343 @@
+// Файл: main.cpp
+// Нагрузочный генератор: N виртуальных пользователей поверх CNetworkWrapper
+
+#include "CNetworkWrapper.h"
+#include "EndpointSelector.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QNetworkAccessManager>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QQueue>
+#include <QHash>
+#include <QVector>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+namespace {
+
+/// Параметры прогона
+struct Options {
+    int users = 10;
+    int rampUpMs = 5000;
+    int cycles = 5;
+    int maxTopics = 5;
+    int transports = 1;
+    int timeoutMs = 30000;
+    QStringList urls;
+    QString email;
+    QString password;
+};
+
+/// Собранные замеры
+struct LoadStats {
+    QHash<QString, QVector<double>> latencies;  ///< Шаг -> задержки в мс
+    QHash<QString, int> errors;                 ///< Шаг -> число ошибок
+
+    void record(const QString& step, double ms) { latencies[step].append(ms); }
+    void fail(const QString& step) { ++errors[step]; }
+};
+
+double percentile(const QVector<double>& sorted, double p) {
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    const int rank = qBound(0, int(p / 100.0 * sorted.size() + 0.5) - 1, int(sorted.size()) - 1);
+    return sorted.at(rank);
+}
+
+/**
+ * @brief Виртуальный пользователь
+ *
+ * Проходит сценарий: вход, затем cycles раз курсы -> дерево тем -> обновление токена.
+ */
+class VirtualUser {
+public:
+    VirtualUser(int index, const Options& options, QNetworkAccessManager* transport,
+                EndpointSelector* selector, LoadStats& stats, std::function<void()> onFinished)
+        : index(index),
+          options(options),
+          stats(stats),
+          onFinished(std::move(onFinished)),
+          network(new CNetworkWrapper(transport, nullptr)) // Сессия только в памяти
+    {
+        // Серверы проверяет один общий объект на транспорт, а не каждый пользователь
+        network->setEndpointSelector(selector);
+
+        timeout.setSingleShot(true);
+        timeout.setInterval(options.timeoutMs);
+        QObject::connect(&timeout, &QTimer::timeout, network.get(), [this]() { finishStep(false); });
+
+        QObject::connect(network.get(), &CNetworkWrapper::authSuccess, network.get(), [this]() {
+            if (step == Step::Login || step == Step::Refresh) {
+                finishStep(true);
+            }
+        });
+        QObject::connect(network.get(), &CNetworkWrapper::coursesReceived, network.get(),
+                         [this](const QJsonArray& courses) {
+            if (step != Step::Courses) {
+                return;
+            }
+            courseId = courses.isEmpty() ? -1 : courses.at(index % courses.size()).toObject()["id"].toInt();
+            finishStep(courseId != -1);
+        });
+        QObject::connect(network.get(), &CNetworkWrapper::subtopicsFetched, network.get(),
+                         [this](int parentTopicId, const QJsonArray& subtopics) {
+            if (step != Step::Topics || parentTopicId != currentTopicId) {
+                return;
+            }
+            for (const auto& topic : subtopics) {
+                pendingTopics.enqueue(topic.toObject()["id"].toInt());
+            }
+            topicDone();
+        });
+        // Лист дерева может прийти без подтем, только с материалами
+        QObject::connect(network.get(), &CNetworkWrapper::materialsFetched, network.get(),
+                         [this](int topicId) {
+            if (step == Step::Topics && topicId == currentTopicId) {
+                topicDone();
+            }
+        });
+
+        const auto failure = [this]() {
+            if (step != Step::Idle && step != Step::Done) {
+                finishStep(false);
+            }
+        };
+        QObject::connect(network.get(), &CNetworkWrapper::errorOccurred, network.get(), failure);
+        QObject::connect(network.get(), &CNetworkWrapper::invalidCredentials, network.get(), failure);
+        QObject::connect(network.get(), &CNetworkWrapper::forbidden_signal, network.get(), failure);
+        // До входа этот сигнал ожидаем: у новой сессии нет токенов
+        QObject::connect(network.get(), &CNetworkWrapper::reauthenticationRequired, network.get(), [this]() {
+            if (step != Step::Idle && step != Step::Login && step != Step::Done) {
+                finishStep(false);
+            }
+        });
+    }
+
+    void start() {
+        begin(Step::Login);
+    }
+
+private:
+    enum class Step { Idle, Login, Courses, Topics, Refresh, Done };
+
+    int index;
+    const Options& options;
+    LoadStats& stats;
+    std::function<void()> onFinished;
+    std::unique_ptr<CNetworkWrapper> network;
+    QTimer timeout;
+    QElapsedTimer stepTimer;
+    Step step = Step::Idle;
+    int cycle = 0;
+    int courseId = -1;
+    int currentTopicId = -1;
+    int topicsFetched = 0;
+    QQueue<int> pendingTopics;
+
+    static QString stepName(Step step) {
+        switch (step) {
+        case Step::Login: return "login";
+        case Step::Courses: return "courses";
+        case Step::Topics: return "topics";
+        case Step::Refresh: return "refresh";
+        default: return "idle";
+        }
+    }
+
+    void begin(Step next) {
+        step = next;
+        stepTimer.start();
+        timeout.start();
+
+        switch (step) {
+        case Step::Login:
+            network->authenticate(options.email.contains("%1") ? options.email.arg(index) : options.email,
+                                  options.password);
+            break;
+        case Step::Courses:
+            network->fetchCourses();
+            break;
+        case Step::Topics:
+            topicsFetched = 0;
+            pendingTopics.clear();
+            currentTopicId = -1;
+            network->fetchTopics(courseId);
+            break;
+        case Step::Refresh:
+            network->refreshAuthToken();
+            break;
+        default:
+            break;
+        }
+    }
+
+    void finishStep(bool ok) {
+        timeout.stop();
+        const Step finished = step;
+        if (ok) {
+            stats.record(stepName(finished), stepTimer.nsecsElapsed() / 1e6);
+        } else {
+            stats.fail(stepName(finished));
+        }
+
+        // Не вошли - дальше идти некуда; прочие ошибки прерывают только текущий цикл
+        if (finished == Step::Login && !ok) {
+            done();
+            return;
+        }
+        Step next = Step::Courses;
+        if (ok && finished == Step::Courses) {
+            next = Step::Topics;
+        } else if (ok && finished == Step::Topics) {
+            next = Step::Refresh;
+        } else if (finished != Step::Login && ++cycle >= options.cycles) {
+            done();
+            return;
+        }
+
+        step = Step::Idle;
+        // Следующий шаг - вне обработчика сигнала обертки
+        QTimer::singleShot(0, network.get(), [this, next]() { begin(next); });
+    }
+
+    void topicDone() {
+        stats.record(stepName(Step::Topics), stepTimer.nsecsElapsed() / 1e6);
+        ++topicsFetched;
+        if (pendingTopics.isEmpty() || topicsFetched >= options.maxTopics) {
+            // Замеры по отдельным темам уже записаны - сразу к обновлению токена
+            timeout.stop();
+            step = Step::Idle;
+            QTimer::singleShot(0, network.get(), [this]() { begin(Step::Refresh); });
+            return;
+        }
+
+        currentTopicId = pendingTopics.dequeue();
+        stepTimer.start();
+        timeout.start();
+        QTimer::singleShot(0, network.get(), [this]() { network->fetchTopics(courseId, currentTopicId); });
+    }
+
+    void done() {
+        step = Step::Done;
+        QTimer::singleShot(0, network.get(), [this]() { onFinished(); });
+    }
+};
+
+void printReport(const LoadStats& stats, double elapsedSec, const Options& options) {
+    QTextStream out(stdout);
+    int total = 0;
+    int failed = 0;
+    for (const auto& samples : stats.latencies) {
+        total += samples.size();
+    }
+    for (int count : stats.errors) {
+        failed += count;
+    }
+
+    out << "Virtual users: " << options.users << ", cycles: " << options.cycles
+        << ", elapsed: " << QString::number(elapsedSec, 'f', 2) << " s\n";
+    out << "Requests: " << total << " ok, " << failed << " failed, throughput "
+        << QString::number(elapsedSec > 0 ? total / elapsedSec : 0.0, 'f', 1) << " req/s\n\n";
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+               .arg(QString("step"), -8).arg(QString("count"), 7).arg(QString("errors"), 7)
+               .arg(QString("p50 ms"), 9).arg(QString("p90 ms"), 9).arg(QString("p95 ms"), 9)
+               .arg(QString("p99 ms"), 9).arg(QString("max ms"), 9);
+
+    for (const QString& step : {QString("login"), QString("courses"), QString("topics"), QString("refresh")}) {
+        QVector<double> sorted = stats.latencies.value(step);
+        std::sort(sorted.begin(), sorted.end());
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                   .arg(step, -8).arg(sorted.size(), 7).arg(stats.errors.value(step), 7)
+                   .arg(percentile(sorted, 50), 9, 'f', 1)
+                   .arg(percentile(sorted, 90), 9, 'f', 1)
+                   .arg(percentile(sorted, 95), 9, 'f', 1)
+                   .arg(percentile(sorted, 99), 9, 'f', 1)
+                   .arg(sorted.isEmpty() ? 0.0 : sorted.last(), 9, 'f', 1);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("LoadGenerator");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Drives virtual users through login, courses, topic tree and "
+                                     "token refresh cycles using CNetworkWrapper");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"url", "API base URL; several comma-separated URLs enable failover.", "url",
+         "http://127.0.0.1:8080"},
+        {"users", "Number of virtual users.", "count", "10"},
+        {"ramp-up", "Time over which users are started, ms.", "ms", "5000"},
+        {"cycles", "Courses/topics/refresh cycles per user.", "count", "5"},
+        {"topics", "Max topic requests per topic tree walk.", "count", "5"},
+        {"transports", "Number of shared network managers.", "count", "1"},
+        {"timeout", "Per-request timeout, ms.", "ms", "30000"},
+        {"email", "Login email; %1 is replaced by the user index.", "email", "user%1@example.com"},
+        {"password", "Login password.", "password", "password"},
+        {"verbose", "Keep the client library debug output."},
+    });
+    parser.process(app);
+
+    Options options;
+    options.urls = parser.value("url").split(',', Qt::SkipEmptyParts);
+    options.users = qMax(1, parser.value("users").toInt());
+    options.rampUpMs = qMax(0, parser.value("ramp-up").toInt());
+    options.cycles = qMax(1, parser.value("cycles").toInt());
+    options.maxTopics = qMax(1, parser.value("topics").toInt());
+    options.transports = qBound(1, parser.value("transports").toInt(), options.users);
+    options.timeoutMs = qMax(1, parser.value("timeout").toInt());
+    options.email = parser.value("email");
+    options.password = parser.value("password");
+
+    // Отладочный вывод библиотеки на каждый ответ искажает замеры
+    if (!parser.isSet("verbose")) {
+        qInstallMessageHandler([](QtMsgType type, const QMessageLogContext&, const QString& message) {
+            if (type != QtDebugMsg && type != QtInfoMsg) {
+                QTextStream(stderr) << message << '\n';
+            }
+        });
+    }
+
+    // QNetworkAccessManager держит не больше 6 соединений на хост,
+    // поэтому пользователей можно распределить по нескольким менеджерам
+    QVector<QNetworkAccessManager*> transports;
+    QVector<EndpointSelector*> selectors;
+    for (int i = 0; i < options.transports; ++i) {
+        transports.append(new QNetworkAccessManager(&app));
+        selectors.append(new EndpointSelector(transports.last(), &app));
+        selectors.last()->setEndpoints(options.urls);
+    }
+
+    LoadStats stats;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    int finishedUsers = 0;
+    std::vector<std::unique_ptr<VirtualUser>> users;
+
+    const auto onFinished = [&]() {
+        if (++finishedUsers == options.users) {
+            printReport(stats, elapsed.nsecsElapsed() / 1e9, options);
+            app.quit();
+        }
+    };
+
+    for (int i = 0; i < options.users; ++i) {
+        users.push_back(std::make_unique<VirtualUser>(i, options, transports.at(i % options.transports),
+                                                      selectors.at(i % options.transports),
+                                                      stats, onFinished));
+        VirtualUser* user = users.back().get();
+        const int delay = options.users > 1 ? options.rampUpMs * i / (options.users - 1) : 0;
+        QTimer::singleShot(delay, &app, [user]() { user->start(); });
+    }
+
+    const int result = app.exec();
+    users.clear();
+    return result;
+}
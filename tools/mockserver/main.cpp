@@ -0,0 +1,290 @@
+// Файл: main.cpp
+// Локальный mock-сервер API учебной платформы для нагрузочного тестирования
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QHash>
+#include <QVector>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QDebug>
+
+namespace {
+
+/// Тема сгенерированного каталога
+struct MockTopic {
+    int id;
+    int courseId;
+    QVector<int> children;
+};
+
+/// Сгенерированный каталог: курсы, каждый с деревом тем заданной глубины
+struct MockCatalogue {
+    int courseCount = 0;
+    QHash<int, QVector<int>> rootTopics;  ///< Курс -> корневые темы
+    QHash<int, MockTopic> topics;
+
+    void generate(int courses, int topicsPerLevel, int depth) {
+        courseCount = courses;
+        int nextId = 1;
+        for (int course = 1; course <= courses; ++course) {
+            rootTopics[course] = generateLevel(course, topicsPerLevel, depth, nextId);
+        }
+    }
+
+    QVector<int> generateLevel(int course, int width, int depth, int& nextId) {
+        QVector<int> level;
+        if (depth <= 0) {
+            return level;
+        }
+        for (int i = 0; i < width; ++i) {
+            const int id = nextId++;
+            level.append(id);
+            const QVector<int> children = generateLevel(course, width, depth - 1, nextId);
+            topics.insert(id, {id, course, children});
+        }
+        return level;
+    }
+};
+
+QJsonObject courseJson(int id) {
+    return QJsonObject{
+        {"id", id},
+        {"title", QString("Course %1").arg(id)},
+        {"description", QString("Mock course number %1").arg(id)},
+        {"created_at", "2024-01-01T00:00:00Z"}
+    };
+}
+
+QJsonObject topicJson(int id) {
+    return QJsonObject{
+        {"id", id},
+        {"title", QString("Topic %1").arg(id)}
+    };
+}
+
+QJsonArray topicsJson(const QVector<int>& ids) {
+    QJsonArray array;
+    for (int id : ids) {
+        array.append(topicJson(id));
+    }
+    return array;
+}
+
+/// Ответ mock-сервера
+struct MockResponse {
+    int status;
+    QByteArray body;
+};
+
+class MockApi {
+public:
+    explicit MockApi(const MockCatalogue& catalogue) : catalogue(catalogue) {}
+
+    MockResponse handle(const QByteArray& method, const QUrl& url, const QByteArray& body,
+                        const QByteArray& authorization) {
+        const QString path = url.path();
+
+        if (method == "POST" && (path == "/api/auth/login/" || path == "/api/auth/refresh/")) {
+            const QJsonObject request = QJsonDocument::fromJson(body).object();
+            if (path == "/api/auth/login/" && request["password"].toString().isEmpty()) {
+                return json(400, QJsonObject{{"non_field_errors", QJsonArray{"Invalid credentials"}}});
+            }
+            ++tokenCounter;
+            return json(200, QJsonObject{
+                {"access", QString("access-%1").arg(tokenCounter)},
+                {"refresh", QString("refresh-%1").arg(tokenCounter)},
+                {"role", "student"}
+            });
+        }
+        if (method == "POST" && path == "/api/auth/register/") {
+            const QJsonObject request = QJsonDocument::fromJson(body).object();
+            return json(201, QJsonObject{
+                {"id", ++tokenCounter},
+                {"email", request["email"]},
+                {"role", "student"}
+            });
+        }
+
+        if (!authorization.startsWith("Bearer ")) {
+            return json(401, QJsonObject{{"detail", "Authentication credentials were not provided."}});
+        }
+
+        if (method == "GET" && path == "/api/courses/courses") {
+            QJsonArray courses;
+            for (int id = 1; id <= catalogue.courseCount; ++id) {
+                courses.append(courseJson(id));
+            }
+            return paged(url, courses);
+        }
+
+        static const QRegularExpression themes("^/api/courses/(\\d+)/themes/(?:(\\d+)/)?$");
+        const QRegularExpressionMatch match = themes.match(path);
+        if (method == "GET" && match.hasMatch()) {
+            const int courseId = match.captured(1).toInt();
+            if (match.captured(2).isEmpty()) {
+                if (!catalogue.rootTopics.contains(courseId)) {
+                    return json(404, QJsonObject{{"detail", "Not found."}});
+                }
+                return paged(url, topicsJson(catalogue.rootTopics.value(courseId)));
+            }
+
+            const int topicId = match.captured(2).toInt();
+            auto topic = catalogue.topics.constFind(topicId);
+            if (topic == catalogue.topics.constEnd() || topic->courseId != courseId) {
+                return json(404, QJsonObject{{"detail", "Not found."}});
+            }
+            QJsonObject result = topicJson(topicId);
+            result["subtopics"] = topicsJson(topic->children);
+            result["materials"] = QJsonArray{QJsonObject{
+                {"id", topicId},
+                {"title", QString("Material for topic %1").arg(topicId)}
+            }};
+            return json(200, result);
+        }
+
+        return json(404, QJsonObject{{"detail", "Not found."}});
+    }
+
+private:
+    const MockCatalogue& catalogue;
+    int tokenCounter = 0;
+
+    static MockResponse json(int status, const QJsonObject& object) {
+        return {status, QJsonDocument(object).toJson(QJsonDocument::Compact)};
+    }
+
+    static MockResponse paged(const QUrl& url, const QJsonArray& items) {
+        const QUrlQuery query(url);
+        if (!query.hasQueryItem("limit")) {
+            return {200, QJsonDocument(items).toJson(QJsonDocument::Compact)};
+        }
+        const int limit = query.queryItemValue("limit").toInt();
+        const int offset = query.queryItemValue("offset").toInt();
+        QJsonArray page;
+        for (int i = offset; i < items.size() && i < offset + limit; ++i) {
+            page.append(items.at(i));
+        }
+        return json(200, QJsonObject{{"count", items.size()}, {"results", page}});
+    }
+};
+
+QByteArray reasonPhrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    default: return "Status";
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("MockServer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Mock API server for load and failover testing");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"port", "Port to listen on.", "port", "8080"},
+        {"latency", "Artificial response delay in milliseconds.", "ms", "0"},
+        {"courses", "Number of generated courses.", "count", "20"},
+        {"topics", "Topics per tree level.", "count", "5"},
+        {"depth", "Depth of each course topic tree.", "levels", "3"},
+    });
+    parser.process(app);
+
+    MockCatalogue catalogue;
+    catalogue.generate(parser.value("courses").toInt(), parser.value("topics").toInt(),
+                       parser.value("depth").toInt());
+    MockApi api(catalogue);
+    const int latencyMs = parser.value("latency").toInt();
+
+    QTcpServer server;
+    QHash<QTcpSocket*, QByteArray> buffers;
+
+    QObject::connect(&server, &QTcpServer::newConnection, [&]() {
+        while (QTcpSocket* socket = server.nextPendingConnection()) {
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, [&buffers, socket]() {
+                buffers.remove(socket);
+                socket->deleteLater();
+            });
+
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [&, socket]() {
+                QByteArray& buffer = buffers[socket];
+                buffer += socket->readAll();
+
+                // В одном буфере может быть несколько запросов keep-alive
+                for (;;) {
+                    const int headerEnd = buffer.indexOf("\r\n\r\n");
+                    if (headerEnd < 0) {
+                        return;
+                    }
+                    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+                    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+                    if (requestLine.size() < 2) {
+                        socket->disconnectFromHost();
+                        return;
+                    }
+
+                    int contentLength = 0;
+                    QByteArray authorization;
+                    for (int i = 1; i < lines.size(); ++i) {
+                        const int colon = lines[i].indexOf(':');
+                        const QByteArray name = lines[i].left(colon).trimmed().toLower();
+                        const QByteArray value = lines[i].mid(colon + 1).trimmed();
+                        if (name == "content-length") {
+                            contentLength = value.toInt();
+                        } else if (name == "authorization") {
+                            authorization = value;
+                        }
+                    }
+                    if (buffer.size() < headerEnd + 4 + contentLength) {
+                        return;
+                    }
+
+                    const QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+                    buffer.remove(0, headerEnd + 4 + contentLength);
+
+                    const MockResponse response = api.handle(
+                        requestLine[0], QUrl(QString::fromLatin1(requestLine[1])), body, authorization);
+
+                    QByteArray raw = "HTTP/1.1 " + QByteArray::number(response.status) + ' '
+                        + reasonPhrase(response.status) + "\r\n"
+                        + "Content-Type: application/json\r\n"
+                        + "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n"
+                        + "Connection: keep-alive\r\n\r\n";
+                    // На HEAD тело не отправляется, иначе клиент примет его за следующий ответ
+                    if (requestLine[0] != "HEAD") {
+                        raw += response.body;
+                    }
+
+                    QTimer::singleShot(latencyMs, socket, [socket, raw]() {
+                        socket->write(raw);
+                    });
+                }
+            });
+        }
+    });
+
+    const quint16 port = quint16(parser.value("port").toUInt());
+    if (!server.listen(QHostAddress::LocalHost, port)) {
+        qCritical() << "Failed to listen on port" << port << ":" << server.errorString();
+        return 1;
+    }
+    qInfo() << "Mock API listening on http://127.0.0.1:" << port
+            << "with" << catalogue.courseCount << "courses," << catalogue.topics.size() << "topics";
+
+    return app.exec();
+}